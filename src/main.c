@@ -1,14 +1,32 @@
+#define _GNU_SOURCE
 #define _POSIX_C_SOURCE 200809L
 
 #include <errno.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <arpa/inet.h>
+#include <linux/perf_event.h>
+#include <netinet/in.h>
+#include <poll.h>
 #include <sys/ioctl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <sys/syscall.h>
 #include <termios.h>
 #include <time.h>
 #include <unistd.h>
@@ -17,7 +35,20 @@
 #include <SDL2/SDL.h>
 
 #define INITIAL_HASH_CAPACITY 2048
+#define CELL_SET_MIGRATE_STEP 8
+#define LOOKUP_BATCH 16
 #define COUNT_HASH_CAPACITY 4096
+#define TILE_HASH_CAPACITY 256
+#define TILE_SIZE 32
+#define TILE_HALO 16
+#define WINDOW_SIZE (TILE_SIZE + 2 * TILE_HALO)
+#define DIST_REBALANCE_INTERVAL 64
+#define HEADLESS_CHUNK 256
+#define INTERACTIVE_STEP_CHUNK 1024
+#define METRICS_DUMP_INTERVAL 1.0
+#define ESCAPE_CHECK_INTERVAL 64
+#define ESCAPE_MARGIN 8
+#define ESCAPE_MAX_CELLS 18
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 
@@ -61,16 +92,150 @@ static void setup_terminal(void) {
     }
 }
 
-struct cell {
-    int x;
-    int y;
-    struct cell *next;
+struct engine_counters {
+    atomic_uint_fast64_t cells_updated;
+    atomic_uint_fast64_t allocations;
 };
 
+static struct engine_counters counters;
+
+static void counter_add(atomic_uint_fast64_t *counter, uint64_t amount) {
+    atomic_fetch_add_explicit(counter, amount, memory_order_relaxed);
+}
+
+/* With --huge-pages, tables of at least one huge page come straight from
+   mmap: explicit hugetlbfs pages when the system has some reserved, else
+   ordinary pages aligned to 2 MiB and advised for transparent huge pages.
+   Smaller tables, and every table without the option, use calloc. */
+#define HUGE_PAGE_SIZE ((size_t)2 << 20)
+
+struct huge_page_counters {
+    atomic_size_t mapped_bytes;
+    atomic_uint_fast64_t hugetlb_tables;
+    atomic_uint_fast64_t advised_tables;
+};
+
+static bool huge_pages_enabled = false;
+static struct huge_page_counters huge_pages;
+
+static bool table_is_mapped(size_t bytes) {
+    return huge_pages_enabled && bytes >= HUGE_PAGE_SIZE;
+}
+
+static size_t huge_page_round(size_t bytes) {
+    return (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+}
+
+static void *table_alloc(size_t count, size_t size) {
+    size_t bytes = count * size;
+    if (!table_is_mapped(bytes)) {
+        void *table = calloc(count, size);
+        if (!table) {
+            perror("calloc");
+            exit(EXIT_FAILURE);
+        }
+        return table;
+    }
+    size_t length = huge_page_round(bytes);
+    void *table = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (table != MAP_FAILED) {
+        counter_add(&huge_pages.hugetlb_tables, 1);
+        atomic_fetch_add_explicit(&huge_pages.mapped_bytes, length, memory_order_relaxed);
+        return table;
+    }
+    /* Over-map by one huge page and trim, so the table starts on a huge
+       page boundary and every 2 MiB of it can be backed by one page. */
+    char *raw = mmap(NULL, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        perror("mmap");
+        exit(EXIT_FAILURE);
+    }
+    char *aligned = (char *)(((uintptr_t)raw + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1));
+    if (aligned > raw) {
+        munmap(raw, (size_t)(aligned - raw));
+    }
+    munmap(aligned + length, HUGE_PAGE_SIZE - (size_t)(aligned - raw));
+    madvise(aligned, length, MADV_HUGEPAGE);
+    counter_add(&huge_pages.advised_tables, 1);
+    atomic_fetch_add_explicit(&huge_pages.mapped_bytes, length, memory_order_relaxed);
+    return aligned;
+}
+
+static void table_free(void *table, size_t count, size_t size) {
+    if (!table) {
+        return;
+    }
+    size_t bytes = count * size;
+    if (!table_is_mapped(bytes)) {
+        free(table);
+        return;
+    }
+    munmap(table, huge_page_round(bytes));
+    atomic_fetch_sub_explicit(&huge_pages.mapped_bytes, huge_page_round(bytes), memory_order_relaxed);
+}
+
+/* Bump allocator for objects that all die together (the tiles of one
+   generation, the contents of a tile store). Chunks double from a small
+   first one up to a huge page, so short-lived small maps stay cheap. */
+struct arena_chunk {
+    struct arena_chunk *next;
+    size_t size;
+    size_t used;
+    max_align_t data[];
+};
+
+struct arena {
+    struct arena_chunk *chunks;
+};
+
+#define ARENA_FIRST_CHUNK ((size_t)4 << 10)
+
+static void *arena_alloc(struct arena *arena, size_t bytes) {
+    bytes = (bytes + sizeof(max_align_t) - 1) & ~(sizeof(max_align_t) - 1);
+    struct arena_chunk *chunk = arena->chunks;
+    if (!chunk || chunk->used + bytes > chunk->size) {
+        size_t total = chunk ? MIN((chunk->size + sizeof(*chunk)) * 2, HUGE_PAGE_SIZE) : ARENA_FIRST_CHUNK;
+        total = MAX(total, bytes + sizeof(*chunk));
+        struct arena_chunk *fresh = table_alloc(1, total);
+        counter_add(&counters.allocations, 1);
+        fresh->next = chunk;
+        fresh->size = total - sizeof(*fresh);
+        fresh->used = 0;
+        arena->chunks = chunk = fresh;
+    }
+    void *result = (char *)chunk->data + chunk->used;
+    chunk->used += bytes;
+    return result;
+}
+
+static void arena_release(struct arena *arena) {
+    struct arena_chunk *chunk = arena->chunks;
+    while (chunk) {
+        struct arena_chunk *next = chunk->next;
+        table_free(chunk, 1, chunk->size + sizeof(*chunk));
+        chunk = next;
+    }
+    arena->chunks = NULL;
+}
+
+/* Live cells are packed into one 64-bit key each and stored in a flat
+   linear-probing table. Key 0 (the cell at the origin) doubles as the empty
+   slot marker and is tracked by `has_zero` instead.
+
+   Growing never rehashes in one go: the previous table stays readable in
+   `old_slots` while each insert moves the next CELL_SET_MIGRATE_STEP of its
+   slots across, so the cost of a resize is spread over many operations.
+   Keys removed before they migrate keep their old slot, so its probe runs
+   stay intact, and are marked in the `old_dead` bitmap instead. */
 struct cell_set {
-    struct cell **buckets;
+    uint64_t *slots;
     size_t capacity;
     size_t size;
+    bool has_zero;
+    uint64_t *old_slots;
+    uint64_t *old_dead;
+    size_t old_capacity;
+    size_t migrate_cursor;
 };
 
 static uint64_t mix64(uint64_t x) {
@@ -82,702 +247,7210 @@ static uint64_t mix64(uint64_t x) {
     return x;
 }
 
-static size_t cell_hash(const struct cell_set *set, int x, int y) {
-    uint64_t key = ((uint64_t)(uint32_t)x << 32) ^ (uint32_t)y;
-    return (size_t)(mix64(key) % set->capacity);
+static uint64_t cell_key(int x, int y) {
+    return ((uint64_t)(uint32_t)x << 32) ^ (uint32_t)y;
+}
+
+static int cell_key_x(uint64_t key) {
+    return (int)(uint32_t)(key >> 32);
+}
+
+static int cell_key_y(uint64_t key) {
+    return (int)(uint32_t)key;
+}
+
+static size_t next_power_of_two(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
 }
 
 static void cell_set_init(struct cell_set *set, size_t capacity) {
-    set->capacity = capacity;
+    set->capacity = next_power_of_two(MAX(capacity, (size_t)16));
     set->size = 0;
-    set->buckets = calloc(set->capacity, sizeof(struct cell *));
-    if (!set->buckets) {
-        perror("calloc");
-        exit(EXIT_FAILURE);
-    }
+    set->has_zero = false;
+    set->old_slots = NULL;
+    set->old_dead = NULL;
+    set->old_capacity = 0;
+    set->migrate_cursor = 0;
+    set->slots = table_alloc(set->capacity, sizeof(*set->slots));
+    counter_add(&counters.allocations, 1);
+}
+
+static void cell_set_drop_old(struct cell_set *set) {
+    table_free(set->old_slots, set->old_capacity, sizeof(*set->old_slots));
+    free(set->old_dead);
+    set->old_slots = NULL;
+    set->old_dead = NULL;
+    set->old_capacity = 0;
+    set->migrate_cursor = 0;
 }
 
 static void cell_set_clear(struct cell_set *set) {
-    if (!set->buckets) {
+    if (!set->slots) {
         return;
     }
-    for (size_t i = 0; i < set->capacity; ++i) {
-        struct cell *node = set->buckets[i];
-        while (node) {
-            struct cell *next = node->next;
-            free(node);
-            node = next;
-        }
-        set->buckets[i] = NULL;
-    }
+    cell_set_drop_old(set);
+    memset(set->slots, 0, set->capacity * sizeof(*set->slots));
     set->size = 0;
+    set->has_zero = false;
 }
 
 static void cell_set_destroy(struct cell_set *set) {
-    cell_set_clear(set);
-    free(set->buckets);
-    set->buckets = NULL;
+    cell_set_drop_old(set);
+    table_free(set->slots, set->capacity, sizeof(*set->slots));
+    set->slots = NULL;
     set->capacity = 0;
     set->size = 0;
+    set->has_zero = false;
+}
+
+static size_t slot_find(const uint64_t *slots, size_t capacity, uint64_t key) {
+    size_t mask = capacity - 1;
+    size_t index = (size_t)mix64(key) & mask;
+    while (slots[index] != 0 && slots[index] != key) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+static size_t cell_set_find(const struct cell_set *set, uint64_t key) {
+    return slot_find(set->slots, set->capacity, key);
+}
+
+static bool cell_set_old_dead(const struct cell_set *set, size_t slot) {
+    return set->old_dead && (set->old_dead[slot / 64] >> (slot % 64) & 1);
+}
+
+/* The old table is never written while it drains, so its probe runs stay
+   intact. A key there is live only if it has not moved yet (slots below the
+   cursor have) and was not removed since. */
+static bool cell_set_find_old(const struct cell_set *set, uint64_t key, size_t *slot) {
+    if (!set->old_slots) {
+        return false;
+    }
+    size_t index = slot_find(set->old_slots, set->old_capacity, key);
+    *slot = index;
+    return set->old_slots[index] == key && index >= set->migrate_cursor && !cell_set_old_dead(set, index);
+}
+
+static bool cell_set_contains_key(const struct cell_set *set, uint64_t key) {
+    if (set->slots[cell_set_find(set, key)] == key) {
+        return true;
+    }
+    size_t slot;
+    return cell_set_find_old(set, key, &slot);
 }
 
 static bool cell_set_contains(const struct cell_set *set, int x, int y) {
-    if (!set->buckets) {
+    if (!set->slots) {
         return false;
     }
-    size_t index = cell_hash(set, x, y);
-    struct cell *node = set->buckets[index];
-    while (node) {
-        if (node->x == x && node->y == y) {
-            return true;
+    uint64_t key = cell_key(x, y);
+    if (key == 0) {
+        return set->has_zero;
+    }
+    return cell_set_contains_key(set, key);
+}
+
+static void cell_set_migrate(struct cell_set *set, size_t slots) {
+    size_t end = MIN(set->old_capacity, set->migrate_cursor + slots);
+    for (size_t i = set->migrate_cursor; i < end; ++i) {
+        uint64_t key = set->old_slots[i];
+        if (key != 0 && !cell_set_old_dead(set, i)) {
+            set->slots[cell_set_find(set, key)] = key;
         }
-        node = node->next;
     }
-    return false;
+    set->migrate_cursor = end;
+    if (end == set->old_capacity) {
+        cell_set_drop_old(set);
+    }
 }
 
 static void cell_set_expand(struct cell_set *set);
 
 static void cell_set_insert(struct cell_set *set, int x, int y) {
-    if (cell_set_contains(set, x, y)) {
+    uint64_t key = cell_key(x, y);
+    if (key == 0) {
+        if (!set->has_zero) {
+            set->has_zero = true;
+            set->size++;
+        }
         return;
     }
-    if ((set->size + 1) * 2 > set->capacity) {
-        cell_set_expand(set);
+    if (set->old_slots) {
+        cell_set_migrate(set, CELL_SET_MIGRATE_STEP);
     }
-    size_t index = cell_hash(set, x, y);
-    struct cell *node = malloc(sizeof(*node));
-    if (!node) {
-        perror("malloc");
-        exit(EXIT_FAILURE);
+    if (cell_set_contains_key(set, key)) {
+        return;
+    }
+    if ((set->size + 1) * 4 > set->capacity * 3) {
+        cell_set_expand(set);
     }
-    node->x = x;
-    node->y = y;
-    node->next = set->buckets[index];
-    set->buckets[index] = node;
+    set->slots[cell_set_find(set, key)] = key;
     set->size++;
 }
 
-static void cell_set_expand(struct cell_set *set) {
-    size_t new_capacity = set->capacity ? set->capacity * 2 : INITIAL_HASH_CAPACITY;
-    struct cell **new_buckets = calloc(new_capacity, sizeof(struct cell *));
-    if (!new_buckets) {
-        perror("calloc");
-        exit(EXIT_FAILURE);
+static bool cell_set_remove(struct cell_set *set, int x, int y) {
+    if (!set->slots) {
+        return false;
     }
-    for (size_t i = 0; i < set->capacity; ++i) {
-        struct cell *node = set->buckets[i];
-        while (node) {
-            struct cell *next = node->next;
-            uint64_t key = ((uint64_t)(uint32_t)node->x << 32) ^ (uint32_t)node->y;
-            size_t index = (size_t)(mix64(key) % new_capacity);
-            node->next = new_buckets[index];
-            new_buckets[index] = node;
-            node = next;
+    uint64_t key = cell_key(x, y);
+    if (key == 0) {
+        bool removed = set->has_zero;
+        set->has_zero = false;
+        set->size -= removed ? 1 : 0;
+        return removed;
+    }
+    if (set->old_slots) {
+        cell_set_migrate(set, CELL_SET_MIGRATE_STEP);
+    }
+    size_t hole = cell_set_find(set, key);
+    if (set->slots[hole] != key) {
+        size_t slot;
+        if (!cell_set_find_old(set, key, &slot)) {
+            return false;
+        }
+        if (!set->old_dead) {
+            set->old_dead = calloc((set->old_capacity + 63) / 64, sizeof(*set->old_dead));
+            if (!set->old_dead) {
+                perror("calloc");
+                exit(EXIT_FAILURE);
+            }
+        }
+        set->old_dead[slot / 64] |= (uint64_t)1 << (slot % 64);
+        set->size--;
+        return true;
+    }
+    /* Backward-shift deletion: pull later members of the probe run into the
+       hole unless that would move them before their home slot. */
+    size_t mask = set->capacity - 1;
+    for (size_t j = (hole + 1) & mask; set->slots[j] != 0; j = (j + 1) & mask) {
+        size_t home = (size_t)mix64(set->slots[j]) & mask;
+        if (((j - home) & mask) >= ((j - hole) & mask)) {
+            set->slots[hole] = set->slots[j];
+            hole = j;
         }
     }
-    free(set->buckets);
-    set->buckets = new_buckets;
-    set->capacity = new_capacity;
+    set->slots[hole] = 0;
+    set->size--;
+    return true;
+}
+
+/* The new table is twice the size, so before it reaches the load limit again
+   at least old_capacity * 3/4 inserts run, each migrating
+   CELL_SET_MIGRATE_STEP slots: the old table is always drained by then and
+   the synchronous migrate below is only a safety net. */
+static void cell_set_expand(struct cell_set *set) {
+    if (set->old_slots) {
+        cell_set_migrate(set, set->old_capacity);
+    }
+    uint64_t *slots = table_alloc(set->capacity * 2, sizeof(*slots));
+    counter_add(&counters.allocations, 1);
+    set->old_slots = set->slots;
+    set->old_capacity = set->capacity;
+    set->migrate_cursor = 0;
+    set->slots = slots;
+    set->capacity *= 2;
+}
+
+static size_t cell_set_count(const struct cell_set *set) {
+    return set->size;
 }
 
+/* Walks the current table, then the part of the old table that has not
+   been migrated yet. */
 struct cell_iterator {
     const struct cell_set *set;
-    size_t bucket;
-    struct cell *node;
+    size_t index;
+    bool zero_pending;
 };
 
 static struct cell_iterator cell_set_iter(const struct cell_set *set) {
-    struct cell_iterator it = {set, 0, NULL};
-    if (set->capacity > 0) {
-        for (size_t i = 0; i < set->capacity; ++i) {
-            if (set->buckets[i]) {
-                it.bucket = i;
-                it.node = set->buckets[i];
-                break;
-            }
-        }
-    }
+    struct cell_iterator it = {set, 0, set->has_zero};
     return it;
 }
 
 static bool cell_iter_next(struct cell_iterator *it, int *x, int *y) {
-    if (!it->set || !it->set->buckets) {
-        return false;
+    if (it->zero_pending) {
+        it->zero_pending = false;
+        *x = 0;
+        *y = 0;
+        return true;
     }
-    if (!it->node) {
-        for (size_t i = it->bucket + 1; i < it->set->capacity; ++i) {
-            if (it->set->buckets[i]) {
-                it->bucket = i;
-                it->node = it->set->buckets[i];
-                break;
-            }
+    const struct cell_set *set = it->set;
+    while (it->index < set->capacity) {
+        uint64_t key = set->slots[it->index++];
+        if (key != 0) {
+            *x = cell_key_x(key);
+            *y = cell_key_y(key);
+            return true;
         }
-        if (!it->node) {
-            return false;
+    }
+    size_t old_index = it->index - set->capacity + set->migrate_cursor;
+    while (set->old_slots && old_index < set->old_capacity) {
+        bool dead = cell_set_old_dead(set, old_index);
+        uint64_t key = set->old_slots[old_index++];
+        it->index++;
+        if (key != 0 && !dead) {
+            *x = cell_key_x(key);
+            *y = cell_key_y(key);
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Batched lookups hash every key first and prefetch its home slot, then
+   probe; the misses overlap instead of stalling one after another. */
+static void cell_set_contains_batch(const struct cell_set *set, const uint64_t *keys, size_t count, bool *found) {
+    if (!set->slots) {
+        memset(found, 0, count * sizeof(*found));
+        return;
+    }
+    size_t mask = set->capacity - 1;
+    for (size_t base = 0; base < count; base += LOOKUP_BATCH) {
+        size_t n = MIN((size_t)LOOKUP_BATCH, count - base);
+        size_t index[LOOKUP_BATCH];
+        for (size_t i = 0; i < n; ++i) {
+            index[i] = (size_t)mix64(keys[base + i]) & mask;
+            __builtin_prefetch(&set->slots[index[i]]);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t key = keys[base + i];
+            if (key == 0) {
+                found[base + i] = set->has_zero;
+                continue;
+            }
+            size_t slot = index[i];
+            while (set->slots[slot] != 0 && set->slots[slot] != key) {
+                slot = (slot + 1) & mask;
+            }
+            size_t old_slot;
+            found[base + i] = set->slots[slot] == key || cell_set_find_old(set, key, &old_slot);
         }
     }
-    *x = it->node->x;
-    *y = it->node->y;
-    it->node = it->node->next;
-    return true;
 }
 
+/* Neighbour counts use the same flat layout; an explicit `used` flag frees
+   every key, including the origin, for real cells. */
 struct count_entry {
-    int x;
-    int y;
+    uint64_t key;
     int count;
-    struct count_entry *next;
+    bool used;
 };
 
 struct count_map {
-    struct count_entry **buckets;
+    struct count_entry *slots;
     size_t capacity;
+    size_t size;
 };
 
-static size_t count_hash(const struct count_map *map, int x, int y) {
-    uint64_t key = ((uint64_t)(uint32_t)x << 32) ^ (uint32_t)y;
-    return (size_t)(mix64(key) % map->capacity);
-}
-
 static void count_map_init(struct count_map *map, size_t capacity) {
-    map->capacity = capacity;
-    map->buckets = calloc(map->capacity, sizeof(struct count_entry *));
-    if (!map->buckets) {
-        perror("calloc");
-        exit(EXIT_FAILURE);
-    }
+    map->capacity = next_power_of_two(MAX(capacity, (size_t)16));
+    map->size = 0;
+    map->slots = table_alloc(map->capacity, sizeof(*map->slots));
+    counter_add(&counters.allocations, 1);
 }
 
 static void count_map_destroy(struct count_map *map) {
-    if (!map->buckets) {
-        return;
+    table_free(map->slots, map->capacity, sizeof(*map->slots));
+    map->slots = NULL;
+    map->capacity = 0;
+    map->size = 0;
+}
+
+static struct count_entry *count_map_slot(struct count_map *map, uint64_t key) {
+    size_t mask = map->capacity - 1;
+    size_t index = (size_t)mix64(key) & mask;
+    while (map->slots[index].used && map->slots[index].key != key) {
+        index = (index + 1) & mask;
     }
-    for (size_t i = 0; i < map->capacity; ++i) {
-        struct count_entry *node = map->buckets[i];
-        while (node) {
-            struct count_entry *next = node->next;
-            free(node);
-            node = next;
+    return &map->slots[index];
+}
+
+static void count_map_expand(struct count_map *map) {
+    struct count_map old = *map;
+    count_map_init(map, old.capacity * 2);
+    for (size_t i = 0; i < old.capacity; ++i) {
+        if (old.slots[i].used) {
+            *count_map_slot(map, old.slots[i].key) = old.slots[i];
         }
     }
-    free(map->buckets);
-    map->buckets = NULL;
-    map->capacity = 0;
+    map->size = old.size;
+    table_free(old.slots, old.capacity, sizeof(*old.slots));
 }
 
 static struct count_entry *count_map_get(struct count_map *map, int x, int y) {
-    size_t index = count_hash(map, x, y);
-    struct count_entry *node = map->buckets[index];
-    while (node) {
-        if (node->x == x && node->y == y) {
-            return node;
-        }
-        node = node->next;
+    uint64_t key = cell_key(x, y);
+    struct count_entry *entry = count_map_slot(map, key);
+    if (entry->used) {
+        return entry;
     }
-    struct count_entry *entry = malloc(sizeof(*entry));
-    if (!entry) {
-        perror("malloc");
-        exit(EXIT_FAILURE);
+    if ((map->size + 1) * 4 > map->capacity * 3) {
+        count_map_expand(map);
+        entry = count_map_slot(map, key);
     }
-    entry->x = x;
-    entry->y = y;
+    entry->key = key;
     entry->count = 0;
-    entry->next = map->buckets[index];
-    map->buckets[index] = entry;
+    entry->used = true;
+    map->size++;
     return entry;
 }
 
-static void count_map_increment(struct count_map *map, int x, int y) {
-    struct count_entry *entry = count_map_get(map, x, y);
-    entry->count += 1;
+static void count_map_increment_batch(struct count_map *map, const uint64_t *keys, size_t count) {
+    for (size_t base = 0; base < count; base += LOOKUP_BATCH) {
+        size_t n = MIN((size_t)LOOKUP_BATCH, count - base);
+        /* Grow up front so the prefetched slots stay valid for the batch. */
+        while ((map->size + n) * 4 > map->capacity * 3) {
+            count_map_expand(map);
+        }
+        size_t mask = map->capacity - 1;
+        size_t index[LOOKUP_BATCH];
+        for (size_t i = 0; i < n; ++i) {
+            index[i] = (size_t)mix64(keys[base + i]) & mask;
+            __builtin_prefetch(&map->slots[index[i]], 1);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t key = keys[base + i];
+            struct count_entry *entry = &map->slots[index[i]];
+            while (entry->used && entry->key != key) {
+                entry = &map->slots[(size_t)(entry - map->slots + 1) & mask];
+            }
+            if (!entry->used) {
+                entry->key = key;
+                entry->count = 0;
+                entry->used = true;
+                map->size++;
+            }
+            entry->count += 1;
+        }
+    }
+}
+
+static double monotonic_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
 }
 
-struct life_state {
-    struct cell_set live;
-    size_t generation;
+struct numa_topology {
+    int node_count;
+    int *node_ids;
+    int *cpu_offsets;
+    int *cpus;
 };
 
-static void life_state_init(struct life_state *state) {
-    cell_set_init(&state->live, INITIAL_HASH_CAPACITY);
-    state->generation = 0;
+static int parse_id_list(const char *text, int **out) {
+    int count = 0;
+    int capacity = 0;
+    const char *p = text;
+    while (*p) {
+        char *end = NULL;
+        long first = strtol(p, &end, 10);
+        if (end == p) {
+            break;
+        }
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            last = strtol(p + 1, &end, 10);
+            p = end;
+        }
+        for (long id = first; id <= last; ++id) {
+            if (count == capacity) {
+                capacity = capacity ? capacity * 2 : 16;
+                int *grown = realloc(*out, (size_t)capacity * sizeof(int));
+                if (!grown) {
+                    perror("realloc");
+                    exit(EXIT_FAILURE);
+                }
+                *out = grown;
+            }
+            (*out)[count++] = (int)id;
+        }
+        if (*p == ',') {
+            p++;
+        }
+    }
+    return count;
 }
 
-static void life_state_clear(struct life_state *state) {
-    cell_set_clear(&state->live);
-    state->generation = 0;
+static bool read_text_file(const char *path, char *buffer, size_t size) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        return false;
+    }
+    size_t len = fread(buffer, 1, size - 1, fp);
+    buffer[len] = '\0';
+    fclose(fp);
+    return len > 0;
 }
 
-static void life_state_destroy(struct life_state *state) {
-    cell_set_destroy(&state->live);
+/* Drops the CPUs this process may not run on, keeping the order. */
+static int filter_allowed_cpus(int *cpus, int count, const cpu_set_t *allowed) {
+    int kept = 0;
+    for (int i = 0; i < count; ++i) {
+        if (!allowed || (cpus[i] >= 0 && cpus[i] < CPU_SETSIZE && CPU_ISSET(cpus[i], allowed))) {
+            cpus[kept++] = cpus[i];
+        }
+    }
+    return kept;
 }
 
-static void life_state_step(struct life_state *state) {
-    struct count_map counts;
-    count_map_init(&counts, COUNT_HASH_CAPACITY);
+static void numa_topology_discover(struct numa_topology *topo) {
+    memset(topo, 0, sizeof(*topo));
+    cpu_set_t allowed_set;
+    const cpu_set_t *allowed = sched_getaffinity(0, sizeof(allowed_set), &allowed_set) == 0 ? &allowed_set : NULL;
+    char text[4096];
+    int *node_ids = NULL;
+    int node_count = 0;
+    if (read_text_file("/sys/devices/system/node/online", text, sizeof(text))) {
+        node_count = parse_id_list(text, &node_ids);
+    }
 
-    struct cell_iterator it = cell_set_iter(&state->live);
-    int x, y;
-    while (cell_iter_next(&it, &x, &y)) {
-        for (int dy = -1; dy <= 1; ++dy) {
-            for (int dx = -1; dx <= 1; ++dx) {
-                if (dx == 0 && dy == 0) {
-                    continue;
-                }
-                count_map_increment(&counts, x + dx, y + dy);
-            }
+    topo->cpu_offsets = calloc((size_t)MAX(node_count, 1) + 1, sizeof(int));
+    if (!topo->cpu_offsets) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < node_count; ++i) {
+        char path[128];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node_ids[i]);
+        int *cpus = NULL;
+        int cpu_count = read_text_file(path, text, sizeof(text)) ? parse_id_list(text, &cpus) : 0;
+        cpu_count = filter_allowed_cpus(cpus, cpu_count, allowed);
+        int total = topo->cpu_offsets[topo->node_count];
+        if (cpu_count == 0) {
+            free(cpus);
+            continue;
         }
+        int *grown = realloc(topo->cpus, (size_t)(total + cpu_count) * sizeof(int));
+        if (!grown) {
+            perror("realloc");
+            exit(EXIT_FAILURE);
+        }
+        topo->cpus = grown;
+        memcpy(topo->cpus + total, cpus, (size_t)cpu_count * sizeof(int));
+        free(cpus);
+        node_ids[topo->node_count] = node_ids[i];
+        topo->node_count++;
+        topo->cpu_offsets[topo->node_count] = total + cpu_count;
     }
 
-    struct cell_set next;
-    cell_set_init(&next, state->live.capacity);
-
-    for (size_t i = 0; i < counts.capacity; ++i) {
-        struct count_entry *entry = counts.buckets[i];
-        while (entry) {
-            bool alive = cell_set_contains(&state->live, entry->x, entry->y);
-            if (entry->count == 3 || (alive && entry->count == 2)) {
-                cell_set_insert(&next, entry->x, entry->y);
-            }
-            entry = entry->next;
+    if (topo->node_count == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        int cpu_count = online > 0 ? (int)online : 1;
+        free(node_ids);
+        node_ids = calloc(1, sizeof(int));
+        topo->cpus = malloc((size_t)cpu_count * sizeof(int));
+        if (!node_ids || !topo->cpus) {
+            perror("malloc");
+            exit(EXIT_FAILURE);
         }
+        for (int i = 0; i < cpu_count; ++i) {
+            topo->cpus[i] = i;
+        }
+        int kept = filter_allowed_cpus(topo->cpus, cpu_count, allowed);
+        cpu_count = kept > 0 ? kept : cpu_count;
+        topo->node_count = 1;
+        topo->cpu_offsets[1] = cpu_count;
     }
+    topo->node_ids = node_ids;
+}
 
-    cell_set_clear(&state->live);
-    free(state->live.buckets);
-    state->live = next;
-    state->generation += 1;
-
-    count_map_destroy(&counts);
+static void numa_topology_destroy(struct numa_topology *topo) {
+    free(topo->node_ids);
+    free(topo->cpu_offsets);
+    free(topo->cpus);
+    memset(topo, 0, sizeof(*topo));
 }
 
-static int life_state_import_file(struct life_state *state, const char *path) {
+static bool numa_node_meminfo(int node_id, unsigned long long *total_kb, unsigned long long *free_kb) {
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/meminfo", node_id);
     FILE *fp = fopen(path, "r");
     if (!fp) {
-        return -1;
+        return false;
     }
-    life_state_clear(state);
-    char *line = NULL;
-    size_t len = 0;
-    ssize_t read;
-    int y = 0;
-    while ((read = getline(&line, &len, fp)) != -1) {
-        if (read > 0 && (line[0] == '!' || line[0] == '#')) {
-            continue;
-        }
-        for (int x = 0; x < read; ++x) {
-            char c = line[x];
-            if (c == '\n' || c == '\r') {
-                break;
-            }
-            if (c == 'O' || c == 'o' || c == 'X' || c == '1') {
-                cell_set_insert(&state->live, x, y);
-            }
+    char line[256];
+    *total_kb = 0;
+    *free_kb = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        unsigned long long value;
+        if (sscanf(line, "Node %*d MemTotal: %llu kB", &value) == 1) {
+            *total_kb = value;
+        } else if (sscanf(line, "Node %*d MemFree: %llu kB", &value) == 1) {
+            *free_kb = value;
         }
-        y += 1;
     }
-    free(line);
     fclose(fp);
-    return 0;
+    return *total_kb > 0;
 }
 
-static size_t cell_set_count(const struct cell_set *set) {
-    return set->size;
+static void pin_current_thread(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) == -1) {
+        perror("sched_setaffinity");
+    }
 }
 
-struct view_state {
-    int center_x;
-    int center_y;
-    int scale;
-    double fractional_x;
-    double fractional_y;
+/* Rounds a waiting thread keeps looking for tasks to steal before it sleeps
+   until its group finishes or more work is queued. */
+#define SCHEDULER_SPIN 64
+
+struct task_group {
+    atomic_size_t pending;
 };
 
-static void view_init(struct view_state *view) {
-    view->center_x = 0;
-    view->center_y = 0;
-    view->scale = 1;
-    view->fractional_x = 0.0;
-    view->fractional_y = 0.0;
+struct task {
+    void (*fn)(void *arg);
+    void *arg;
+    struct task_group *group;
+};
+
+struct task_deque {
+    pthread_mutex_t lock;
+    struct task *items;
+    size_t head;
+    size_t tail;
+    size_t capacity;
+};
+
+struct worker_stats {
+    uint64_t tasks;
+    uint64_t steals;
+    double busy_seconds;
+};
+
+struct scheduler;
+
+struct worker_context {
+    struct scheduler *sched;
+    int index;
+};
+
+struct scheduler {
+    int worker_count;
+    pthread_t *threads;
+    struct worker_context *contexts;
+    struct task_deque *deques;
+    struct worker_stats *stats;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t finished;
+    atomic_size_t queued;
+    int sleepers;
+    int waiters;
+    bool stopping;
+    double stats_started;
+    bool numa;
+    int node_count;
+    int *node_ids;
+    int *node_first_worker;
+    int *worker_node;
+    int *worker_cpu;
+    /* Bytes of the tiles stepped on each node in the last block: the tile
+       plus the content it points at, which other tiles may share. */
+    size_t *node_tile_bytes;
+    size_t *node_peak_tile_bytes;
+};
+
+static _Thread_local int current_worker = 0;
+
+static void task_deque_push(struct task_deque *deque, struct task task) {
+    pthread_mutex_lock(&deque->lock);
+    if (deque->tail == deque->capacity) {
+        size_t used = deque->tail - deque->head;
+        if (deque->capacity == 0 || used * 2 > deque->capacity) {
+            size_t new_capacity = deque->capacity ? deque->capacity * 2 : 64;
+            struct task *items = realloc(deque->items, new_capacity * sizeof(struct task));
+            if (!items) {
+                perror("realloc");
+                exit(EXIT_FAILURE);
+            }
+            deque->items = items;
+            deque->capacity = new_capacity;
+        }
+        memmove(deque->items, deque->items + deque->head, used * sizeof(struct task));
+        deque->head = 0;
+        deque->tail = used;
+    }
+    deque->items[deque->tail++] = task;
+    pthread_mutex_unlock(&deque->lock);
 }
 
-static void view_zoom_in(struct view_state *view) {
-    view->scale = MAX(1, view->scale / 2);
+static bool task_deque_pop(struct task_deque *deque, struct task *task, bool steal) {
+    bool found = false;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->head < deque->tail) {
+        *task = steal ? deque->items[deque->head++] : deque->items[--deque->tail];
+        found = true;
+        if (deque->head == deque->tail) {
+            deque->head = 0;
+            deque->tail = 0;
+        }
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
 }
 
-static void view_zoom_out(struct view_state *view) {
-    if (view->scale < 1024) {
-        view->scale *= 2;
+static bool scheduler_take(struct scheduler *sched, int worker, struct task *task) {
+    if (task_deque_pop(&sched->deques[worker], task, false)) {
+        atomic_fetch_sub(&sched->queued, 1);
+        return true;
+    }
+    /* Workers are seeded with spatially adjacent runs of work, so victims are
+       tried in order of ring distance to keep stolen tiles near our own. */
+    for (int distance = 1; distance < sched->worker_count; ++distance) {
+        int ahead = (worker + distance) % sched->worker_count;
+        int behind = (worker - distance + sched->worker_count) % sched->worker_count;
+        if (task_deque_pop(&sched->deques[ahead], task, true) ||
+            (behind != ahead && task_deque_pop(&sched->deques[behind], task, true))) {
+            atomic_fetch_sub(&sched->queued, 1);
+            sched->stats[worker].steals++;
+            return true;
+        }
     }
+    return false;
 }
 
-static void view_pan(struct view_state *view, int dx, int dy) {
-    view->center_x += dx * view->scale;
-    view->center_y += dy * view->scale;
-    view->fractional_x = 0.0;
-    view->fractional_y = 0.0;
+static void scheduler_execute(struct scheduler *sched, int worker, const struct task *task) {
+    double start = monotonic_seconds();
+    task->fn(task->arg);
+    sched->stats[worker].busy_seconds += monotonic_seconds() - start;
+    sched->stats[worker].tasks++;
+    if (atomic_fetch_sub(&task->group->pending, 1) == 1) {
+        pthread_mutex_lock(&sched->lock);
+        if (sched->waiters > 0) {
+            pthread_cond_broadcast(&sched->finished);
+        }
+        pthread_mutex_unlock(&sched->lock);
+    }
 }
 
-static void view_pan_pixels(struct view_state *view, double dx_pixels, double dy_pixels) {
-    if (dx_pixels == 0.0 && dy_pixels == 0.0) {
-        return;
+static void *scheduler_worker_main(void *arg) {
+    struct worker_context *context = arg;
+    struct scheduler *sched = context->sched;
+    current_worker = context->index;
+    if (sched->numa) {
+        pin_current_thread(sched->worker_cpu[current_worker]);
     }
 
-    double scaled_dx = dx_pixels * (double)view->scale / (double)BASE_TILE_PIXELS;
-    double scaled_dy = dy_pixels * (double)view->scale / (double)BASE_TILE_PIXELS;
+    struct task task;
+    for (;;) {
+        if (scheduler_take(sched, current_worker, &task)) {
+            scheduler_execute(sched, current_worker, &task);
+            continue;
+        }
+        pthread_mutex_lock(&sched->lock);
+        while (!sched->stopping && atomic_load(&sched->queued) == 0) {
+            sched->sleepers++;
+            pthread_cond_wait(&sched->wake, &sched->lock);
+            sched->sleepers--;
+        }
+        bool stopping = sched->stopping;
+        pthread_mutex_unlock(&sched->lock);
+        if (stopping) {
+            return NULL;
+        }
+    }
+}
 
-    view->fractional_x += scaled_dx;
-    view->fractional_y += scaled_dy;
+static void scheduler_assign_nodes(struct scheduler *sched, const struct numa_topology *topo) {
+    sched->node_count = sched->numa ? MIN(topo->node_count, sched->worker_count) : 1;
+    sched->node_ids = calloc((size_t)sched->node_count, sizeof(int));
+    sched->node_first_worker = calloc((size_t)sched->node_count + 1, sizeof(int));
+    sched->worker_node = calloc((size_t)sched->worker_count, sizeof(int));
+    sched->worker_cpu = calloc((size_t)sched->worker_count, sizeof(int));
+    sched->node_tile_bytes = calloc((size_t)sched->node_count, sizeof(size_t));
+    sched->node_peak_tile_bytes = calloc((size_t)sched->node_count, sizeof(size_t));
+    if (!sched->node_ids || !sched->node_first_worker || !sched->worker_node || !sched->worker_cpu ||
+        !sched->node_tile_bytes || !sched->node_peak_tile_bytes) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    /* Consecutive workers share a node so that ring-distance stealing tries
+       same-node victims before crossing the interconnect. */
+    for (int node = 0; node < sched->node_count; ++node) {
+        sched->node_ids[node] = topo->node_ids[node];
+        sched->node_first_worker[node] = node * sched->worker_count / sched->node_count;
+    }
+    sched->node_first_worker[sched->node_count] = sched->worker_count;
+    for (int node = 0; node < sched->node_count; ++node) {
+        int cpu_first = topo->cpu_offsets[node];
+        int cpu_count = topo->cpu_offsets[node + 1] - cpu_first;
+        for (int w = sched->node_first_worker[node]; w < sched->node_first_worker[node + 1]; ++w) {
+            sched->worker_node[w] = node;
+            sched->worker_cpu[w] = topo->cpus[cpu_first + (w - sched->node_first_worker[node]) % cpu_count];
+        }
+    }
+}
 
-    while (view->fractional_x >= 1.0) {
-        view->center_x += 1;
-        view->fractional_x -= 1.0;
+static struct scheduler *scheduler_create(int worker_count, bool numa) {
+    struct scheduler *sched = calloc(1, sizeof(*sched));
+    if (!sched) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
     }
-    while (view->fractional_x <= -1.0) {
-        view->center_x -= 1;
-        view->fractional_x += 1.0;
+    sched->worker_count = worker_count;
+    sched->threads = calloc((size_t)worker_count, sizeof(pthread_t));
+    sched->contexts = calloc((size_t)worker_count, sizeof(struct worker_context));
+    sched->deques = calloc((size_t)worker_count, sizeof(struct task_deque));
+    sched->stats = calloc((size_t)worker_count, sizeof(struct worker_stats));
+    if (!sched->threads || !sched->contexts || !sched->deques || !sched->stats) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
     }
+    pthread_mutex_init(&sched->lock, NULL);
+    pthread_cond_init(&sched->wake, NULL);
+    pthread_cond_init(&sched->finished, NULL);
+    atomic_init(&sched->queued, 0);
+    sched->stats_started = monotonic_seconds();
 
-    while (view->fractional_y >= 1.0) {
-        view->center_y += 1;
-        view->fractional_y -= 1.0;
+    /* Pinning only pays off across nodes. The calling thread, worker 0, is
+       never pinned: the HTTP thread and forked workers inherit its mask. */
+    struct numa_topology topo;
+    numa_topology_discover(&topo);
+    sched->numa = numa && topo.node_count > 1 && worker_count > 1;
+    scheduler_assign_nodes(sched, &topo);
+    numa_topology_destroy(&topo);
+
+    for (int i = 0; i < worker_count; ++i) {
+        pthread_mutex_init(&sched->deques[i].lock, NULL);
+        sched->contexts[i].sched = sched;
+        sched->contexts[i].index = i;
     }
-    while (view->fractional_y <= -1.0) {
-        view->center_y -= 1;
-        view->fractional_y += 1.0;
+    /* Worker 0 is the thread that waits on task groups. */
+    for (int i = 1; i < worker_count; ++i) {
+        int err = pthread_create(&sched->threads[i], NULL, scheduler_worker_main, &sched->contexts[i]);
+        if (err != 0) {
+            fprintf(stderr, "pthread_create: %s\n", strerror(err));
+            exit(EXIT_FAILURE);
+        }
     }
+    return sched;
 }
 
-static void clear_screen(void) {
-    printf("\033[2J\033[H");
+static void scheduler_destroy(struct scheduler *sched) {
+    if (!sched) {
+        return;
+    }
+    pthread_mutex_lock(&sched->lock);
+    sched->stopping = true;
+    pthread_cond_broadcast(&sched->wake);
+    pthread_mutex_unlock(&sched->lock);
+    for (int i = 1; i < sched->worker_count; ++i) {
+        pthread_join(sched->threads[i], NULL);
+    }
+    for (int i = 0; i < sched->worker_count; ++i) {
+        pthread_mutex_destroy(&sched->deques[i].lock);
+        free(sched->deques[i].items);
+    }
+    pthread_cond_destroy(&sched->wake);
+    pthread_cond_destroy(&sched->finished);
+    pthread_mutex_destroy(&sched->lock);
+    free(sched->node_ids);
+    free(sched->node_first_worker);
+    free(sched->worker_node);
+    free(sched->worker_cpu);
+    free(sched->node_tile_bytes);
+    free(sched->node_peak_tile_bytes);
+    free(sched->threads);
+    free(sched->contexts);
+    free(sched->deques);
+    free(sched->stats);
+    free(sched);
 }
 
-static void render_state_terminal(const struct life_state *life, const struct view_state *view, bool paused, int delay_ms, const char *info_message) {
-    struct winsize ws;
-    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == -1) {
-        ws.ws_col = 80;
-        ws.ws_row = 24;
+static void scheduler_spawn_on(struct scheduler *sched, int worker, struct task_group *group, void (*fn)(void *), void *arg) {
+    struct task task = {fn, arg, group};
+    atomic_fetch_add(&group->pending, 1);
+    atomic_fetch_add(&sched->queued, 1);
+    task_deque_push(&sched->deques[worker], task);
+    pthread_mutex_lock(&sched->lock);
+    if (sched->sleepers > 0) {
+        pthread_cond_signal(&sched->wake);
     }
-    int rows = ws.ws_row > 4 ? ws.ws_row - 4 : ws.ws_row;
-    int cols = ws.ws_col;
-
-    clear_screen();
-
-    int half_rows = rows / 2;
-    int half_cols = cols / 2;
+    if (sched->waiters > 0) {
+        pthread_cond_broadcast(&sched->finished);
+    }
+    pthread_mutex_unlock(&sched->lock);
+}
 
-    for (int row = 0; row < rows; ++row) {
-        for (int col = 0; col < cols; ++col) {
-            int origin_x = view->center_x - half_cols * view->scale + col * view->scale;
-            int origin_y = view->center_y - half_rows * view->scale + row * view->scale;
-            bool alive = false;
-            for (int dy = 0; dy < view->scale && !alive; ++dy) {
-                for (int dx = 0; dx < view->scale; ++dx) {
-                    if (cell_set_contains(&life->live, origin_x + dx, origin_y + dy)) {
-                        alive = true;
-                        break;
-                    }
-                }
+static void scheduler_wait(struct scheduler *sched, struct task_group *group) {
+    struct task task;
+    int idle = 0;
+    while (atomic_load(&group->pending) > 0) {
+        if (scheduler_take(sched, current_worker, &task)) {
+            scheduler_execute(sched, current_worker, &task);
+            idle = 0;
+        } else if (++idle < SCHEDULER_SPIN) {
+            sched_yield();
+        } else {
+            /* The last task of the group broadcasts under the lock, so the
+               check below cannot miss it. */
+            pthread_mutex_lock(&sched->lock);
+            while (atomic_load(&group->pending) > 0 && atomic_load(&sched->queued) == 0) {
+                sched->waiters++;
+                pthread_cond_wait(&sched->finished, &sched->lock);
+                sched->waiters--;
             }
-            putchar(alive ? 'O' : '.');
+            pthread_mutex_unlock(&sched->lock);
+            idle = 0;
         }
-        putchar('\n');
     }
+}
 
-    printf("Generation: %zu | Live cells: %zu | Speed: %d ms | Scale: %d | Center: (%d,%d)\n", life->generation, cell_set_count(&life->live), delay_ms, view->scale, view->center_x, view->center_y);
-    printf("Status: %s | Controls: q=quit p=pause/resume n=step w/a/s/d=pan +/-=zoom | r=reset to origin\n", paused ? "paused" : "running");
-    if (info_message && *info_message) {
-        printf("Info: %s\n", info_message);
-    } else {
-        printf("Info: \n");
+static void scheduler_reset_stats(struct scheduler *sched) {
+    memset(sched->stats, 0, (size_t)sched->worker_count * sizeof(struct worker_stats));
+    memset(sched->node_peak_tile_bytes, 0, (size_t)sched->node_count * sizeof(size_t));
+    sched->stats_started = monotonic_seconds();
+}
+
+static void scheduler_print_stats(const struct scheduler *sched, FILE *out) {
+    double wall = monotonic_seconds() - sched->stats_started;
+    for (int i = 0; i < sched->worker_count; ++i) {
+        const struct worker_stats *stats = &sched->stats[i];
+        fprintf(out, "Worker %d: tasks %llu | steals %llu | busy %.3f s | utilization %.1f%%", i,
+                (unsigned long long)stats->tasks, (unsigned long long)stats->steals, stats->busy_seconds,
+                wall > 0.0 ? 100.0 * stats->busy_seconds / wall : 0.0);
+        if (sched->numa && i == 0) {
+            fprintf(out, " | node %d unpinned", sched->node_ids[sched->worker_node[i]]);
+        } else if (sched->numa) {
+            fprintf(out, " | node %d cpu %d", sched->node_ids[sched->worker_node[i]], sched->worker_cpu[i]);
+        }
+        fputc('\n', out);
+    }
+    if (!sched->numa) {
+        return;
+    }
+    for (int node = 0; node < sched->node_count; ++node) {
+        unsigned long long total_kb = 0;
+        unsigned long long free_kb = 0;
+        fprintf(out, "Node %d: workers %d | tile memory %zu KiB (peak %zu KiB)", sched->node_ids[node],
+                sched->node_first_worker[node + 1] - sched->node_first_worker[node], sched->node_tile_bytes[node] / 1024,
+                sched->node_peak_tile_bytes[node] / 1024);
+        if (numa_node_meminfo(sched->node_ids[node], &total_kb, &free_kb)) {
+            fprintf(out, " | free %llu MiB of %llu MiB", free_kb / 1024, total_kb / 1024);
+        }
+        fputc('\n', out);
     }
-    fflush(stdout);
 }
 
-static void render_state_sdl(SDL_Renderer *renderer, const struct life_state *life, const struct view_state *view, int window_w, int window_h) {
-    const int threshold_scale = MAX(1, BASE_TILE_PIXELS / MIN_DISTINGUISHABLE_PIXELS);
+struct life_census {
+    size_t population;
+    size_t births;
+    size_t deaths;
+    int min_x;
+    int min_y;
+    int max_x;
+    int max_y;
+    /* Coordinate sums of the live cells and of the cells that changed in the
+       last stepping call; the camera derives centroids from them. */
+    int64_t sum_x;
+    int64_t sum_y;
+    int64_t change_sum_x;
+    int64_t change_sum_y;
+};
 
-    int cell_span;
-    int tile_pixels;
-    if (view->scale <= threshold_scale) {
-        cell_span = 1;
-        tile_pixels = BASE_TILE_PIXELS / view->scale;
-        if (tile_pixels < 1) {
-            tile_pixels = 1;
-        }
+static void life_census_reset(struct life_census *census) {
+    memset(census, 0, sizeof(*census));
+}
+
+static void life_census_add(struct life_census *census, int x, int y) {
+    if (census->population == 0) {
+        census->min_x = census->max_x = x;
+        census->min_y = census->max_y = y;
     } else {
-        cell_span = (view->scale + threshold_scale - 1) / threshold_scale;
-        tile_pixels = BASE_TILE_PIXELS / threshold_scale;
-        if (tile_pixels < 1) {
-            tile_pixels = 1;
-        }
+        census->min_x = MIN(census->min_x, x);
+        census->max_x = MAX(census->max_x, x);
+        census->min_y = MIN(census->min_y, y);
+        census->max_y = MAX(census->max_y, y);
     }
+    census->population++;
+    census->sum_x += x;
+    census->sum_y += y;
+}
 
-    int cols = (window_w + tile_pixels - 1) / tile_pixels;
-    int rows = (window_h + tile_pixels - 1) / tile_pixels;
-    if (cols < 1) {
-        cols = 1;
+static void life_census_add_cell(struct life_census *census, int x, int y, bool born) {
+    life_census_add(census, x, y);
+    if (born) {
+        census->births++;
+        census->change_sum_x += x;
+        census->change_sum_y += y;
     }
-    if (rows < 1) {
-        rows = 1;
+}
+
+static void life_census_add_next(struct life_census *census, const struct cell_set *previous, int x, int y) {
+    life_census_add_cell(census, x, y, !cell_set_contains(previous, x, y));
+}
+
+/* Survivors are the new cells that were not born, so the cells (and
+   coordinate sums) that died follow from the previous census alone. */
+static void life_census_finish(struct life_census *census, const struct life_census *previous) {
+    size_t survivors = census->population - census->births;
+    int64_t survivor_x = census->sum_x - census->change_sum_x;
+    int64_t survivor_y = census->sum_y - census->change_sum_y;
+    census->deaths = previous->population - survivors;
+    census->change_sum_x += previous->sum_x - survivor_x;
+    census->change_sum_y += previous->sum_y - survivor_y;
+}
+
+/* Folds the census of a disjoint region into `total`. */
+static void life_census_merge(struct life_census *total, const struct life_census *part) {
+    if (part->population > 0) {
+        if (total->population == 0) {
+            total->min_x = part->min_x;
+            total->min_y = part->min_y;
+            total->max_x = part->max_x;
+            total->max_y = part->max_y;
+        } else {
+            total->min_x = MIN(total->min_x, part->min_x);
+            total->min_y = MIN(total->min_y, part->min_y);
+            total->max_x = MAX(total->max_x, part->max_x);
+            total->max_y = MAX(total->max_y, part->max_y);
+        }
     }
+    total->population += part->population;
+    total->births += part->births;
+    total->deaths += part->deaths;
+    total->sum_x += part->sum_x;
+    total->sum_y += part->sum_y;
+    total->change_sum_x += part->change_sum_x;
+    total->change_sum_y += part->change_sum_y;
+}
 
-    int half_cols = cols / 2;
-    int half_rows = rows / 2;
+/* Fixed-capacity open-addressing set that many threads can insert into at
+   once. Slots hold packed cell keys and are claimed with a CAS; key 0 (the
+   cell at the origin) doubles as the empty marker and is tracked separately. */
+struct concurrent_cell_set {
+    _Atomic uint64_t *slots;
+    size_t capacity;
+    atomic_size_t size;
+    atomic_bool has_zero;
+};
 
-    SDL_SetRenderDrawColor(renderer, 16, 16, 24, 255);
-    SDL_RenderClear(renderer);
+static void concurrent_cell_set_init(struct concurrent_cell_set *set, size_t expected) {
+    set->capacity = next_power_of_two(MAX(expected * 2, (size_t)1024));
+    set->slots = table_alloc(set->capacity, sizeof(*set->slots));
+    atomic_init(&set->size, 0);
+    atomic_init(&set->has_zero, false);
+}
 
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-    for (int row = 0; row < rows; ++row) {
-        for (int col = 0; col < cols; ++col) {
-            int origin_x = view->center_x - half_cols * cell_span + col * cell_span;
-            int origin_y = view->center_y - half_rows * cell_span + row * cell_span;
-            bool alive = false;
-            if (cell_span == 1) {
-                alive = cell_set_contains(&life->live, origin_x, origin_y);
-            } else {
-                for (int dy = 0; dy < cell_span && !alive; ++dy) {
-                    for (int dx = 0; dx < cell_span; ++dx) {
-                        if (cell_set_contains(&life->live, origin_x + dx, origin_y + dy)) {
-                            alive = true;
-                            break;
-                        }
-                    }
-                }
+static void concurrent_cell_set_destroy(struct concurrent_cell_set *set) {
+    table_free((void *)set->slots, set->capacity, sizeof(*set->slots));
+    set->slots = NULL;
+    set->capacity = 0;
+}
+
+static bool concurrent_cell_set_insert(struct concurrent_cell_set *set, int x, int y) {
+    uint64_t key = cell_key(x, y);
+    if (key == 0) {
+        bool inserted = !atomic_exchange(&set->has_zero, true);
+        if (inserted) {
+            atomic_fetch_add(&set->size, 1);
+        }
+        return inserted;
+    }
+    size_t mask = set->capacity - 1;
+    size_t index = (size_t)mix64(key) & mask;
+    for (size_t probes = 0; probes < set->capacity; ++probes) {
+        uint64_t current = atomic_load_explicit(&set->slots[index], memory_order_relaxed);
+        if (current == key) {
+            return false;
+        }
+        if (current == 0) {
+            uint64_t expected = 0;
+            if (atomic_compare_exchange_strong(&set->slots[index], &expected, key)) {
+                atomic_fetch_add(&set->size, 1);
+                return true;
             }
-            if (alive) {
-                SDL_Rect rect = {col * tile_pixels, row * tile_pixels, tile_pixels, tile_pixels};
-                SDL_RenderFillRect(renderer, &rect);
+            if (expected == key) {
+                return false;
             }
         }
+        index = (index + 1) & mask;
     }
+    fprintf(stderr, "concurrent cell set full (%zu slots)\n", set->capacity);
+    exit(EXIT_FAILURE);
+}
 
-    SDL_SetRenderDrawColor(renderer, 72, 72, 72, 255);
-    int render_width = cols * tile_pixels;
-    int render_height = rows * tile_pixels;
-    if (render_width < window_w) {
-        render_width = window_w;
-    }
-    if (render_height < window_h) {
-        render_height = window_h;
-    }
-    for (int col = 0; col <= cols; ++col) {
-        int x = col * tile_pixels;
-        SDL_RenderDrawLine(renderer, x, 0, x, render_height);
+static size_t concurrent_cell_set_count(const struct concurrent_cell_set *set) {
+    return atomic_load(&set->size);
+}
+
+static void concurrent_cell_set_drain(const struct concurrent_cell_set *set, struct cell_set *out, const struct cell_set *previous,
+                                      struct life_census *census) {
+    if (atomic_load(&set->has_zero)) {
+        cell_set_insert(out, 0, 0);
+        life_census_add_next(census, previous, 0, 0);
     }
-    for (int row = 0; row <= rows; ++row) {
-        int y = row * tile_pixels;
-        SDL_RenderDrawLine(renderer, 0, y, render_width, y);
+    for (size_t i = 0; i < set->capacity; ++i) {
+        uint64_t key = atomic_load_explicit(&set->slots[i], memory_order_relaxed);
+        if (key != 0) {
+            int x = cell_key_x(key);
+            int y = cell_key_y(key);
+            cell_set_insert(out, x, y);
+            life_census_add_next(census, previous, x, y);
+        }
     }
 }
 
-static int run_terminal(struct life_state *life, int delay_ms) {
-    setup_terminal();
+/* Tile contents are hash-consed: every distinct 32x32 bit pattern is stored
+   once in a tile_store and tiles only point at it, so the many identical
+   tiles of ash share storage. */
+struct tile_content {
+    uint32_t rows[TILE_SIZE];
+    uint64_t hash;
+    uint32_t id;
+    uint32_t cache_id;
+    struct tile_content *next;
+};
 
-    struct view_state view;
-    view_init(&view);
+struct tile {
+    int tx;
+    int ty;
+    struct tile_content *content;
+    struct tile *next;
+};
 
-    bool paused = false;
-    bool single_step = false;
-    bool running = true;
-    char info_message[128] = "Press q to quit, p to pause.";
+struct tile_map {
+    struct tile **buckets;
+    size_t capacity;
+    size_t size;
+    struct arena arena;
+};
 
-    render_state_terminal(life, &view, paused, delay_ms, info_message);
-    info_message[0] = '\0';
+static int tile_coord(int v) {
+    return v >= 0 ? v / TILE_SIZE : -((-(v + 1)) / TILE_SIZE) - 1;
+}
 
-    while (running) {
-        ssize_t bytes = 0;
-        char ch;
-        while ((bytes = read(STDIN_FILENO, &ch, 1)) > 0) {
-            if (ch == 'q') {
-                running = false;
-                break;
-            } else if (ch == 'p') {
-                paused = !paused;
-            } else if (ch == 'n') {
-                single_step = true;
-            } else if (ch == 'w') {
-                view_pan(&view, 0, -1);
-            } else if (ch == 's') {
-                view_pan(&view, 0, 1);
-            } else if (ch == 'a') {
-                view_pan(&view, -1, 0);
-            } else if (ch == 'd') {
-                view_pan(&view, 1, 0);
-            } else if (ch == '+' || ch == '=') {
-                view_zoom_in(&view);
-            } else if (ch == '-') {
-                view_zoom_out(&view);
-            } else if (ch == 'r') {
-                view_init(&view);
-                snprintf(info_message, sizeof(info_message), "View reset to origin");
+static size_t tile_hash(size_t capacity, int tx, int ty) {
+    uint64_t key = ((uint64_t)(uint32_t)tx << 32) ^ (uint32_t)ty;
+    return (size_t)(mix64(key) % capacity);
+}
+
+static void tile_map_init(struct tile_map *map, size_t capacity) {
+    map->capacity = capacity;
+    map->size = 0;
+    map->arena.chunks = NULL;
+    map->buckets = calloc(map->capacity, sizeof(struct tile *));
+    if (!map->buckets) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void tile_map_destroy(struct tile_map *map) {
+    if (!map->buckets) {
+        return;
+    }
+    arena_release(&map->arena);
+    free(map->buckets);
+    map->buckets = NULL;
+    map->capacity = 0;
+    map->size = 0;
+}
+
+static const struct tile *tile_map_find(const struct tile_map *map, int tx, int ty) {
+    struct tile *node = map->buckets[tile_hash(map->capacity, tx, ty)];
+    while (node) {
+        if (node->tx == tx && node->ty == ty) {
+            return node;
+        }
+        node = node->next;
+    }
+    return NULL;
+}
+
+static void tile_map_expand(struct tile_map *map) {
+    size_t new_capacity = map->capacity * 2;
+    struct tile **new_buckets = calloc(new_capacity, sizeof(struct tile *));
+    if (!new_buckets) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < map->capacity; ++i) {
+        struct tile *node = map->buckets[i];
+        while (node) {
+            struct tile *next = node->next;
+            size_t index = tile_hash(new_capacity, node->tx, node->ty);
+            node->next = new_buckets[index];
+            new_buckets[index] = node;
+            node = next;
+        }
+    }
+    free(map->buckets);
+    map->buckets = new_buckets;
+    map->capacity = new_capacity;
+}
+
+static struct tile *tile_map_get(struct tile_map *map, int tx, int ty) {
+    struct tile *found = (struct tile *)tile_map_find(map, tx, ty);
+    if (found) {
+        return found;
+    }
+    if ((map->size + 1) * 2 > map->capacity) {
+        tile_map_expand(map);
+    }
+    size_t index = tile_hash(map->capacity, tx, ty);
+    struct tile *tile = arena_alloc(&map->arena, sizeof(*tile));
+    tile->tx = tx;
+    tile->ty = ty;
+    tile->next = map->buckets[index];
+    map->buckets[index] = tile;
+    map->size++;
+    return tile;
+}
+
+enum neighbourhood {
+    NEIGHBOURHOOD_MOORE,
+    NEIGHBOURHOOD_VON_NEUMANN,
+    NEIGHBOURHOOD_HEXAGONAL,
+};
+
+#define LTL_MAX_RADIUS TILE_HALO
+
+/* Range-1 rules are described by the birth/survive masks and the
+   neighbourhood: Moore (8 cells), von Neumann (4) or hexagonal (6, on Golly's
+   skewed grid, where (x-1,y-1) and (x+1,y+1) are neighbours but (x+1,y-1)
+   and (x-1,y+1) are not). Larger than Life rules (radius > 1) use the
+   inclusive count ranges instead; `count_self` is Golly's M1, which includes
+   the cell itself in its count. */
+struct life_rule {
+    uint16_t birth;
+    uint16_t survive;
+    int radius;
+    enum neighbourhood neighbourhood;
+    bool count_self;
+    int birth_min;
+    int birth_max;
+    int survive_min;
+    int survive_max;
+};
+
+static const struct life_rule CONWAY_RULE = {1u << 3, (1u << 2) | (1u << 3), 1, NEIGHBOURHOOD_MOORE, false, 0, 0, 0, 0};
+
+static bool life_rule_is_ltl(const struct life_rule *rule) {
+    return rule->radius > 1;
+}
+
+static int life_rule_neighbours(const struct life_rule *rule) {
+    int r = rule->radius;
+    int cells = rule->neighbourhood == NEIGHBOURHOOD_MOORE       ? (2 * r + 1) * (2 * r + 1)
+                : rule->neighbourhood == NEIGHBOURHOOD_HEXAGONAL ? 7
+                                                                 : 2 * r * (r + 1) + 1;
+    return rule->count_self ? cells : cells - 1;
+}
+
+/* Golly's Larger than Life notation, e.g. `R5,C0,M1,S34..58,B34..45,NM`.
+   Only two-state rules (C0 or C2) are supported. */
+static bool life_rule_parse_ltl(const char *text, struct life_rule *rule) {
+    struct life_rule parsed = CONWAY_RULE;
+    int states = 0;
+    int middle = 0;
+    char shape = 0;
+    int consumed = 0;
+    if (sscanf(text, "R%d,C%d,M%d,S%d..%d,B%d..%d,N%c%n", &parsed.radius, &states, &middle, &parsed.survive_min,
+               &parsed.survive_max, &parsed.birth_min, &parsed.birth_max, &shape, &consumed) != 8 ||
+        text[consumed] != '\0') {
+        return false;
+    }
+    if (parsed.radius < 1 || parsed.radius > LTL_MAX_RADIUS || (states != 0 && states != 2) || (middle != 0 && middle != 1) ||
+        (shape != 'M' && shape != 'N')) {
+        return false;
+    }
+    parsed.count_self = middle == 1;
+    parsed.neighbourhood = shape == 'M' ? NEIGHBOURHOOD_MOORE : NEIGHBOURHOOD_VON_NEUMANN;
+    int most = life_rule_neighbours(&parsed);
+    if (parsed.birth_min < 1 || parsed.birth_min > parsed.birth_max || parsed.survive_min > parsed.survive_max ||
+        parsed.survive_min < 0 || parsed.birth_max > most || parsed.survive_max > most) {
+        return false;
+    }
+    if (!life_rule_is_ltl(&parsed)) {
+        /* Radius-1 rules run on the bit-sliced kernels via the masks. */
+        parsed.birth = 0;
+        parsed.survive = 0;
+        for (int n = 0; n <= 8; ++n) {
+            int with_self = n + (parsed.count_self ? 1 : 0);
+            if (n >= parsed.birth_min && n <= parsed.birth_max) {
+                parsed.birth |= (uint16_t)(1u << n);
+            }
+            if (with_self >= parsed.survive_min && with_self <= parsed.survive_max) {
+                parsed.survive |= (uint16_t)(1u << n);
+            }
+        }
+    }
+    *rule = parsed;
+    return true;
+}
+
+static bool life_rule_parse(const char *text, struct life_rule *rule) {
+    if (text[0] == 'R' || text[0] == 'r') {
+        return life_rule_parse_ltl(text, rule);
+    }
+    struct life_rule parsed = CONWAY_RULE;
+    parsed.birth = 0;
+    parsed.survive = 0;
+    uint16_t *target = NULL;
+    bool seen_birth = false;
+    bool seen_survive = false;
+    for (const char *p = text; *p; ++p) {
+        if (*p == 'B' || *p == 'b') {
+            target = &parsed.birth;
+            seen_birth = true;
+        } else if (*p == 'S' || *p == 's') {
+            target = &parsed.survive;
+            seen_survive = true;
+        } else if (*p == '/') {
+            target = NULL;
+        } else if (*p >= '0' && *p <= '8' && target) {
+            *target |= (uint16_t)(1u << (*p - '0'));
+        } else if ((*p == 'H' || *p == 'h') && p[1] == '\0') {
+            parsed.neighbourhood = NEIGHBOURHOOD_HEXAGONAL;
+        } else if ((*p == 'V' || *p == 'v') && p[1] == '\0') {
+            parsed.neighbourhood = NEIGHBOURHOOD_VON_NEUMANN;
+        } else {
+            return false;
+        }
+    }
+    /* B0 would light up the whole infinite plane every generation. */
+    if (!seen_birth || !seen_survive || (parsed.birth & 1u)) {
+        return false;
+    }
+    uint16_t possible = (uint16_t)((2u << life_rule_neighbours(&parsed)) - 1);
+    if ((parsed.birth | parsed.survive) & ~possible) {
+        return false;
+    }
+    *rule = parsed;
+    return true;
+}
+
+static void life_rule_format(const struct life_rule *rule, char *buffer, size_t size) {
+    if (life_rule_is_ltl(rule)) {
+        snprintf(buffer, size, "R%d,C0,M%d,S%d..%d,B%d..%d,N%c", rule->radius, rule->count_self ? 1 : 0, rule->survive_min,
+                 rule->survive_max, rule->birth_min, rule->birth_max, rule->neighbourhood == NEIGHBOURHOOD_MOORE ? 'M' : 'N');
+        return;
+    }
+    size_t len = 0;
+    buffer[len++] = 'B';
+    for (int n = 0; n <= 8 && len + 1 < size; ++n) {
+        if (rule->birth & (1u << n)) {
+            buffer[len++] = (char)('0' + n);
+        }
+    }
+    if (len + 2 < size) {
+        buffer[len++] = '/';
+        buffer[len++] = 'S';
+    }
+    for (int n = 0; n <= 8 && len + 1 < size; ++n) {
+        if (rule->survive & (1u << n)) {
+            buffer[len++] = (char)('0' + n);
+        }
+    }
+    if (rule->neighbourhood != NEIGHBOURHOOD_MOORE && len + 1 < size) {
+        buffer[len++] = rule->neighbourhood == NEIGHBOURHOOD_HEXAGONAL ? 'H' : 'V';
+    }
+    buffer[len] = '\0';
+}
+
+static bool life_rule_equal(const struct life_rule *a, const struct life_rule *b) {
+    return a->birth == b->birth && a->survive == b->survive && a->radius == b->radius && a->neighbourhood == b->neighbourhood &&
+           a->count_self == b->count_self && a->birth_min == b->birth_min && a->birth_max == b->birth_max &&
+           a->survive_min == b->survive_min && a->survive_max == b->survive_max;
+}
+
+static bool life_rule_is_conway(const struct life_rule *rule) {
+    return !life_rule_is_ltl(rule) && rule->neighbourhood == NEIGHBOURHOOD_MOORE && rule->birth == CONWAY_RULE.birth && rule->survive == CONWAY_RULE.survive;
+}
+
+static uint64_t life_rule_apply(const struct life_rule *rule, uint64_t ones, uint64_t twos, uint64_t fours, uint64_t eights, uint64_t self) {
+    uint64_t next = 0;
+    for (int n = 0; n <= 8; ++n) {
+        bool born = rule->birth & (1u << n);
+        bool stays = rule->survive & (1u << n);
+        if (!born && !stays) {
+            continue;
+        }
+        uint64_t match = ((n & 1) ? ones : ~ones) & ((n & 2) ? twos : ~twos) & ((n & 4) ? fours : ~fours) & ((n & 8) ? eights : ~eights);
+        next |= match & (born ? (stays ? ~(uint64_t)0 : ~self) : self);
+    }
+    return next;
+}
+
+static void full_add(uint64_t a, uint64_t b, uint64_t c, uint64_t *sum, uint64_t *carry) {
+    uint64_t t = a ^ b;
+    *sum = t ^ c;
+    *carry = (a & b) | (t & c);
+}
+
+/* Bit b of a window row is the cell at x = b + offset, so `row << 1` lines
+   every cell up with its west neighbour and `row >> 1` with its east one. */
+static void window_step_von_neumann(const uint64_t *src, uint64_t *dst, const struct life_rule *rule) {
+    for (int r = 0; r < WINDOW_SIZE; ++r) {
+        uint64_t above = r > 0 ? src[r - 1] : 0;
+        uint64_t row = src[r];
+        uint64_t below = r + 1 < WINDOW_SIZE ? src[r + 1] : 0;
+        uint64_t s, c;
+        full_add(above, below, row << 1, &s, &c);
+        uint64_t east = row >> 1;
+        uint64_t ones = s ^ east;
+        uint64_t carry = s & east;
+        dst[r] = life_rule_apply(rule, ones, c ^ carry, c & carry, 0, row);
+    }
+}
+
+static void window_step_hexagonal(const uint64_t *src, uint64_t *dst, const struct life_rule *rule) {
+    for (int r = 0; r < WINDOW_SIZE; ++r) {
+        uint64_t above = r > 0 ? src[r - 1] : 0;
+        uint64_t row = src[r];
+        uint64_t below = r + 1 < WINDOW_SIZE ? src[r + 1] : 0;
+        uint64_t s_a, c_a, s_b, c_b, twos, fours;
+        full_add(above << 1, above, row << 1, &s_a, &c_a);
+        full_add(row >> 1, below, below >> 1, &s_b, &c_b);
+        uint64_t ones = s_a ^ s_b;
+        full_add(c_a, c_b, s_a & s_b, &twos, &fours);
+        dst[r] = life_rule_apply(rule, ones, twos, fours, 0, row);
+    }
+}
+
+static void window_step(const uint64_t *src, uint64_t *dst, const struct life_rule *rule) {
+    if (rule->neighbourhood == NEIGHBOURHOOD_VON_NEUMANN) {
+        window_step_von_neumann(src, dst, rule);
+        return;
+    }
+    if (rule->neighbourhood == NEIGHBOURHOOD_HEXAGONAL) {
+        window_step_hexagonal(src, dst, rule);
+        return;
+    }
+    bool conway = life_rule_is_conway(rule);
+    for (int r = 0; r < WINDOW_SIZE; ++r) {
+        uint64_t above = r > 0 ? src[r - 1] : 0;
+        uint64_t row = src[r];
+        uint64_t below = r + 1 < WINDOW_SIZE ? src[r + 1] : 0;
+
+        uint64_t s_a, c_a, s_b, c_b, ones, c_d, t0, t1;
+        full_add(above << 1, above, above >> 1, &s_a, &c_a);
+        full_add(below << 1, below, below >> 1, &s_b, &c_b);
+        uint64_t s_c = (row << 1) ^ (row >> 1);
+        uint64_t c_c = (row << 1) & (row >> 1);
+        full_add(s_a, s_b, s_c, &ones, &c_d);
+        full_add(c_a, c_b, c_c, &t0, &t1);
+        uint64_t twos = t0 ^ c_d;
+        uint64_t t2 = t0 & c_d;
+
+        if (conway) {
+            dst[r] = twos & ~(t1 | t2) & (ones | row);
+        } else {
+            dst[r] = life_rule_apply(rule, ones, twos, t1 ^ t2, t1 & t2, row);
+        }
+    }
+}
+
+#define LTL_WINDOW (TILE_SIZE + 2 * LTL_MAX_RADIUS)
+#define LTL_ROTATED (2 * LTL_WINDOW - 1)
+
+/* Larger than Life counts come from summed-area tables, so the cost per cell
+   does not depend on the radius. A box is four lookups in an ordinary table.
+   A diamond becomes a box after rotating the window by 45 degrees
+   (u = x + y, v = x - y), with the unused half of the rotated lattice left
+   as zeros. */
+static void tile_step_ltl(const struct tile_content *const around[9], uint32_t *out, bool still[2], const struct life_rule *rule) {
+    int r = rule->radius;
+    int width = TILE_SIZE + 2 * r;
+    static _Thread_local uint8_t cells[LTL_WINDOW][LTL_WINDOW];
+    for (int wy = 0; wy < width; ++wy) {
+        int ly = wy - r + TILE_SIZE;
+        for (int wx = 0; wx < width; ++wx) {
+            int lx = wx - r + TILE_SIZE;
+            const struct tile_content *tile = around[(ly / TILE_SIZE) * 3 + lx / TILE_SIZE];
+            cells[wy][wx] = tile ? (uint8_t)((tile->rows[ly % TILE_SIZE] >> (lx % TILE_SIZE)) & 1u) : 0;
+        }
+    }
+
+    static _Thread_local int32_t sums[LTL_ROTATED + 1][LTL_ROTATED + 1];
+    bool diamond = rule->neighbourhood == NEIGHBOURHOOD_VON_NEUMANN;
+    int side = diamond ? 2 * width - 1 : width;
+    for (int i = 0; i <= side; ++i) {
+        sums[0][i] = 0;
+        sums[i][0] = 0;
+    }
+    for (int y = 0; y < side; ++y) {
+        int32_t row = 0;
+        for (int x = 0; x < side; ++x) {
+            if (!diamond) {
+                row += cells[y][x];
+            } else if (((x + y - (width - 1)) & 1) == 0) {
+                /* Rotated (u, v) = (y, x) maps back to cell ((u + v') / 2, (u - v') / 2). */
+                int v = x - (width - 1);
+                int cx = (y + v) / 2;
+                int cy = (y - v) / 2;
+                if (cx >= 0 && cx < width && cy >= 0 && cy < width) {
+                    row += cells[cy][cx];
+                }
+            }
+            sums[y + 1][x + 1] = sums[y][x + 1] + row;
+        }
+    }
+
+    for (int j = 0; j < TILE_SIZE; ++j) {
+        uint32_t bits = 0;
+        for (int i = 0; i < TILE_SIZE; ++i) {
+            int cx = i + r;
+            int cy = j + r;
+            int x0, y0;
+            if (diamond) {
+                x0 = cx - cy + width - 1 - r;
+                y0 = cx + cy - r;
+            } else {
+                x0 = cx - r;
+                y0 = cy - r;
+            }
+            int x1 = x0 + 2 * r + 1;
+            int y1 = y0 + 2 * r + 1;
+            int self = cells[cy][cx];
+            int count = sums[y1][x1] - sums[y0][x1] - sums[y1][x0] + sums[y0][x0] - (rule->count_self ? 0 : self);
+            bool alive = self ? count >= rule->survive_min && count <= rule->survive_max
+                              : count >= rule->birth_min && count <= rule->birth_max;
+            bits |= (uint32_t)alive << i;
+        }
+        out[j] = bits;
+    }
+    still[0] = true;
+    still[1] = false;
+    for (int j = 0; j < TILE_SIZE; ++j) {
+        still[0] = still[0] && out[j] == (around[4] ? around[4]->rows[j] : 0);
+    }
+    counter_add(&counters.cells_updated, TILE_SIZE * TILE_SIZE);
+}
+
+/* `around` holds the contents of the tile and its eight neighbours in row
+   order (NULL for empty ones); `out` receives the tile's rows `gens`
+   generations later. still[0] tells whether the tile's last generation
+   equals the one before it, and for two or more generations still[1] whether
+   it equals the one two before. */
+static void tile_step(const struct tile_content *const around[9], uint32_t *out, bool still[2], int gens, const struct life_rule *rule) {
+    if (life_rule_is_ltl(rule)) {
+        tile_step_ltl(around, out, still, rule);
+        return;
+    }
+    uint64_t window[2][WINDOW_SIZE];
+    memset(window[0], 0, sizeof(window[0]));
+
+    for (int ny = -1; ny <= 1; ++ny) {
+        for (int nx = -1; nx <= 1; ++nx) {
+            const struct tile_content *tile = around[(ny + 1) * 3 + nx + 1];
+            if (!tile) {
+                continue;
+            }
+            int first = ny < 0 ? TILE_SIZE - TILE_HALO : 0;
+            int last = ny > 0 ? TILE_HALO : TILE_SIZE;
+            for (int r = first; r < last; ++r) {
+                uint64_t bits = tile->rows[r];
+                if (nx < 0) {
+                    bits >>= TILE_SIZE - TILE_HALO;
+                } else if (nx == 0) {
+                    bits <<= TILE_HALO;
+                } else {
+                    bits = (bits & ((1u << TILE_HALO) - 1)) << (TILE_HALO + TILE_SIZE);
+                }
+                window[0][r + TILE_HALO + ny * TILE_SIZE] |= bits;
+            }
+        }
+    }
+
+    int current = 0;
+    uint32_t earlier[TILE_SIZE] = {0};
+    for (int g = 0; g < gens; ++g) {
+        if (g == gens - 2) {
+            for (int r = 0; r < TILE_SIZE; ++r) {
+                earlier[r] = (uint32_t)(window[current][r + TILE_HALO] >> TILE_HALO);
+            }
+        }
+        window_step(window[current], window[current ^ 1], rule);
+        current ^= 1;
+    }
+    counter_add(&counters.cells_updated, (uint64_t)gens * TILE_SIZE * TILE_SIZE);
+
+    still[0] = true;
+    still[1] = gens >= 2;
+    for (int r = 0; r < TILE_SIZE; ++r) {
+        out[r] = (uint32_t)(window[current][r + TILE_HALO] >> TILE_HALO);
+        still[0] = still[0] && out[r] == (uint32_t)(window[current ^ 1][r + TILE_HALO] >> TILE_HALO);
+        still[1] = still[1] && out[r] == earlier[r];
+    }
+}
+
+#define TILE_STORE_DEFAULT_BUDGET ((size_t)128 << 20)
+#define TILE_CACHE_UNKNOWN UINT32_MAX
+
+struct memo_cache;
+
+enum tile_memo_state { TILE_MEMO_EMPTY, TILE_MEMO_CLAIMED, TILE_MEMO_USED };
+
+/* `state` goes from empty to claimed when a planning thread takes the slot
+   and to used once that thread has written the key, so other threads only
+   compare keys of used entries. */
+struct tile_memo_entry {
+    uint32_t ids[9];
+    int gens;
+    atomic_uchar state;
+    bool recent;
+    bool still[2];
+    struct tile_content *result;
+};
+
+/* Interned tile contents plus a memo from a tile's 3x3 neighbourhood of
+   content ids (0 for empty) to its contents `gens` generations later. Each
+   distinct neighbourhood is stepped once however many tiles share it, and
+   still or even-period ash keeps hitting the memo block after block.
+
+   Once the store outgrows `budget` bytes it is collected between blocks:
+   contents used by the current tiles or by memo entries looked up since the
+   last collection survive, everything else is swept. Swept contents go on
+   `free_list` with their ids, so ids stay dense and the arena stops growing
+   once the working set fits. */
+struct tile_store {
+    struct tile_content **buckets;
+    size_t capacity;
+    size_t size;
+    size_t peak_size;
+    struct arena contents;
+    struct tile_content *free_list;
+    size_t free_count;
+    uint32_t next_id;
+    struct tile_memo_entry *memo;
+    size_t memo_capacity;
+    size_t memo_size;
+    struct life_rule rule;
+    size_t budget;
+    struct memo_cache *cache;
+    uint64_t memo_hits;
+    uint64_t memo_misses;
+    uint64_t collections;
+    uint64_t reclaimed_bytes;
+    double collect_seconds;
+};
+
+static void tile_store_init(struct tile_store *store) {
+    memset(store, 0, sizeof(*store));
+    store->rule = CONWAY_RULE;
+    store->budget = TILE_STORE_DEFAULT_BUDGET;
+}
+
+static void tile_store_clear(struct tile_store *store) {
+    arena_release(&store->contents);
+    if (store->buckets) {
+        memset(store->buckets, 0, store->capacity * sizeof(*store->buckets));
+    }
+    store->size = 0;
+    store->free_list = NULL;
+    store->free_count = 0;
+    store->next_id = 0;
+    if (store->memo) {
+        memset(store->memo, 0, store->memo_capacity * sizeof(*store->memo));
+    }
+    store->memo_size = 0;
+}
+
+static void memo_cache_close(struct memo_cache *cache);
+
+static void tile_store_destroy(struct tile_store *store) {
+    tile_store_clear(store);
+    memo_cache_close(store->cache);
+    store->cache = NULL;
+    free(store->buckets);
+    table_free(store->memo, store->memo_capacity, sizeof(*store->memo));
+    store->buckets = NULL;
+    store->memo = NULL;
+    store->capacity = 0;
+    store->memo_capacity = 0;
+}
+
+/* Bytes held by contents (live or on the free list) and both tables. */
+static size_t tile_store_bytes(const struct tile_store *store) {
+    return (size_t)store->next_id * sizeof(struct tile_content) + store->capacity * sizeof(*store->buckets) +
+           store->memo_capacity * sizeof(*store->memo);
+}
+
+/* The same without the free list, which is what the budget limits. */
+static size_t tile_store_live_bytes(const struct tile_store *store) {
+    return tile_store_bytes(store) - store->free_count * sizeof(struct tile_content);
+}
+
+static void tile_store_collect(struct tile_store *store, const struct tile_map *tiles);
+
+/* Stores are allocated on first use so that idle life_states stay small. */
+static void tile_store_prepare(struct tile_store *store, const struct life_rule *rule) {
+    if (!store->buckets) {
+        store->capacity = TILE_HASH_CAPACITY;
+        store->buckets = calloc(store->capacity, sizeof(*store->buckets));
+        store->memo_capacity = TILE_HASH_CAPACITY * 4;
+        store->memo = table_alloc(store->memo_capacity, sizeof(*store->memo));
+        if (!store->buckets) {
+            perror("calloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (!life_rule_equal(&store->rule, rule)) {
+        tile_store_clear(store);
+        store->rule = *rule;
+    } else if (tile_store_live_bytes(store) > store->budget) {
+        tile_store_collect(store, NULL);
+    }
+}
+
+static uint64_t tile_content_hash(const uint32_t *rows) {
+    uint64_t hash = 0;
+    for (int r = 0; r < TILE_SIZE; r += 2) {
+        hash = mix64(hash ^ ((uint64_t)rows[r] | (uint64_t)rows[r + 1] << 32));
+    }
+    return hash;
+}
+
+static void tile_store_resize(struct tile_store *store, size_t new_capacity) {
+    struct tile_content **new_buckets = calloc(new_capacity, sizeof(*new_buckets));
+    if (!new_buckets) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < store->capacity; ++i) {
+        struct tile_content *node = store->buckets[i];
+        while (node) {
+            struct tile_content *next = node->next;
+            size_t index = (size_t)(node->hash & (new_capacity - 1));
+            node->next = new_buckets[index];
+            new_buckets[index] = node;
+            node = next;
+        }
+    }
+    free(store->buckets);
+    store->buckets = new_buckets;
+    store->capacity = new_capacity;
+}
+
+/* Returns the shared copy of `rows`, whose tile_content_hash is `hash`, or
+   NULL if the tile is empty. */
+static struct tile_content *tile_store_intern_hashed(struct tile_store *store, const uint32_t *rows, uint64_t hash) {
+    uint32_t any = 0;
+    for (int r = 0; r < TILE_SIZE; ++r) {
+        any |= rows[r];
+    }
+    if (!any) {
+        return NULL;
+    }
+    size_t index = (size_t)(hash & (store->capacity - 1));
+    for (struct tile_content *node = store->buckets[index]; node; node = node->next) {
+        if (node->hash == hash && memcmp(node->rows, rows, sizeof(node->rows)) == 0) {
+            return node;
+        }
+    }
+    if ((store->size + 1) * 2 > store->capacity) {
+        tile_store_resize(store, store->capacity * 2);
+        index = (size_t)(hash & (store->capacity - 1));
+    }
+    struct tile_content *content = store->free_list;
+    if (content) {
+        store->free_list = content->next;
+        store->free_count--;
+    } else {
+        content = arena_alloc(&store->contents, sizeof(*content));
+        content->id = ++store->next_id;
+    }
+    memcpy(content->rows, rows, sizeof(content->rows));
+    content->hash = hash;
+    content->cache_id = TILE_CACHE_UNKNOWN;
+    store->size++;
+    content->next = store->buckets[index];
+    store->buckets[index] = content;
+    store->peak_size = MAX(store->peak_size, store->size);
+    return content;
+}
+
+static struct tile_content *tile_store_intern(struct tile_store *store, const uint32_t *rows) {
+    return tile_store_intern_hashed(store, rows, tile_content_hash(rows));
+}
+
+static size_t tile_memo_hash(const uint32_t *ids, int gens) {
+    uint64_t hash = (uint64_t)gens;
+    for (int i = 0; i < 9; ++i) {
+        hash = mix64(hash ^ ids[i]);
+    }
+    return (size_t)hash;
+}
+
+static size_t tile_memo_find(const struct tile_memo_entry *memo, size_t capacity, const uint32_t *ids, int gens) {
+    size_t mask = capacity - 1;
+    size_t index = tile_memo_hash(ids, gens) & mask;
+    while (memo[index].state != TILE_MEMO_EMPTY &&
+           (memo[index].gens != gens || memcmp(memo[index].ids, ids, sizeof(memo[index].ids)) != 0)) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+/* Looks a neighbourhood up while other threads may be inserting, which is
+   safe as long as the table cannot fill up (see tile_store_reserve). Returns
+   true if this caller added the entry and so has to step it. */
+static bool tile_memo_claim(struct tile_memo_entry *memo, size_t capacity, const uint32_t *ids, int gens, size_t *slot) {
+    size_t mask = capacity - 1;
+    size_t index = tile_memo_hash(ids, gens) & mask;
+    for (;;) {
+        struct tile_memo_entry *entry = &memo[index];
+        unsigned char state = atomic_load_explicit(&entry->state, memory_order_acquire);
+        if (state == TILE_MEMO_EMPTY &&
+            atomic_compare_exchange_strong_explicit(&entry->state, &state, TILE_MEMO_CLAIMED, memory_order_acquire,
+                                                    memory_order_acquire)) {
+            memcpy(entry->ids, ids, sizeof(entry->ids));
+            entry->gens = gens;
+            atomic_store_explicit(&entry->state, TILE_MEMO_USED, memory_order_release);
+            *slot = index;
+            return true;
+        }
+        while (state == TILE_MEMO_CLAIMED) {
+            state = atomic_load_explicit(&entry->state, memory_order_acquire);
+        }
+        if (entry->gens == gens && memcmp(entry->ids, ids, sizeof(entry->ids)) == 0) {
+            *slot = index;
+            return false;
+        }
+        index = (index + 1) & mask;
+    }
+}
+
+static void tile_store_rehash_memo(struct tile_store *store, size_t capacity) {
+    struct tile_memo_entry *memo = table_alloc(capacity, sizeof(*memo));
+    for (size_t i = 0; i < store->memo_capacity; ++i) {
+        if (store->memo[i].state != TILE_MEMO_EMPTY) {
+            memo[tile_memo_find(memo, capacity, store->memo[i].ids, store->memo[i].gens)] = store->memo[i];
+        }
+    }
+    table_free(store->memo, store->memo_capacity, sizeof(*store->memo));
+    store->memo = memo;
+    store->memo_capacity = capacity;
+}
+
+/* Makes room for `extra` new memo entries up front, so slot indices handed
+   out while a block is being planned stay valid until it is finished. */
+static void tile_store_reserve(struct tile_store *store, size_t extra) {
+    size_t capacity = store->memo_capacity;
+    while ((store->memo_size + extra) * 2 > capacity) {
+        capacity *= 2;
+    }
+    if (capacity != store->memo_capacity) {
+        tile_store_rehash_memo(store, capacity);
+    }
+}
+
+/* Drops memo entries (all of them, or those not looked up since the last
+   sweep), then frees every content that neither a remaining entry nor one
+   of `tiles` refers to. */
+static void tile_store_sweep(struct tile_store *store, const struct tile_map *tiles, bool keep_recent) {
+    bool *live = calloc((size_t)store->next_id + 1, sizeof(*live));
+    if (!live) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    store->memo_size = 0;
+    for (size_t i = 0; i < store->memo_capacity; ++i) {
+        struct tile_memo_entry *entry = &store->memo[i];
+        if (entry->state == TILE_MEMO_EMPTY) {
+            continue;
+        }
+        if (!keep_recent || !entry->recent) {
+            memset(entry, 0, sizeof(*entry));
+            continue;
+        }
+        entry->recent = false;
+        store->memo_size++;
+        for (int k = 0; k < 9; ++k) {
+            live[entry->ids[k]] = true;
+        }
+        if (entry->result) {
+            live[entry->result->id] = true;
+        }
+    }
+    if (tiles) {
+        for (size_t i = 0; i < tiles->capacity; ++i) {
+            for (const struct tile *tile = tiles->buckets[i]; tile; tile = tile->next) {
+                live[tile->content->id] = true;
+            }
+        }
+    }
+    for (size_t i = 0; i < store->capacity; ++i) {
+        struct tile_content **link = &store->buckets[i];
+        while (*link) {
+            struct tile_content *content = *link;
+            if (live[content->id]) {
+                link = &content->next;
+                continue;
+            }
+            *link = content->next;
+            content->next = store->free_list;
+            store->free_list = content;
+            store->free_count++;
+            store->size--;
+        }
+    }
+    free(live);
+    size_t capacity = TILE_HASH_CAPACITY;
+    while (store->size * 2 > capacity) {
+        capacity *= 2;
+    }
+    if (capacity < store->capacity) {
+        tile_store_resize(store, capacity);
+    }
+    capacity = TILE_HASH_CAPACITY * 4;
+    while (store->memo_size * 2 > capacity) {
+        capacity *= 2;
+    }
+    tile_store_rehash_memo(store, capacity);
+}
+
+/* Mark and sweep, run between blocks once the store is over budget. The
+   roots are the current tiles (none between stepping calls) and the memo
+   entries looked up since the last collection. If that working set alone is
+   still over budget the memo goes too, leaving only what the tiles use. */
+static void tile_store_collect(struct tile_store *store, const struct tile_map *tiles) {
+    double start = monotonic_seconds();
+    size_t before = tile_store_live_bytes(store);
+    tile_store_sweep(store, tiles, true);
+    if (tile_store_live_bytes(store) > store->budget) {
+        tile_store_sweep(store, tiles, false);
+    }
+    size_t after = tile_store_live_bytes(store);
+    store->collections++;
+    store->reclaimed_bytes += before > after ? before - after : 0;
+    store->collect_seconds += monotonic_seconds() - start;
+}
+
+#define MEMO_CACHE_MAGIC 0x474f4c4du
+#define MEMO_CACHE_VERSION 1u
+#define MEMO_CACHE_DEFAULT_SIZE ((size_t)256 << 20)
+
+/* Layout of a --memo-cache file: a header, an open-addressing table of tile
+   contents, and one of memo results keyed by the file ids (slot + 1, or 0
+   for an empty tile) of a 3x3 neighbourhood. Ids are positions in the file,
+   so they mean the same thing in every run. Nothing is ever removed; once a
+   table is three quarters full, no more is added to it. */
+struct memo_cache_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t tile_size;
+    uint32_t reserved;
+    char rule[64];
+    uint64_t tile_capacity;
+    uint64_t tile_count;
+    uint64_t entry_capacity;
+    uint64_t entry_count;
+};
+
+struct memo_cache_tile {
+    uint64_t tag; /* content hash with the low bit set; 0 while free */
+    uint32_t rows[TILE_SIZE];
+};
+
+struct memo_cache_entry {
+    uint32_t ids[9];
+    uint32_t result;
+    uint16_t gens;
+    uint8_t still;
+    uint8_t used;
+};
+
+struct memo_cache {
+    int fd;
+    size_t bytes;
+    struct memo_cache_header *header;
+    struct memo_cache_tile *tiles;
+    struct memo_cache_entry *entries;
+    struct life_rule rule;
+    uint64_t lookups;
+    uint64_t hits;
+    uint64_t added;
+};
+
+static size_t memo_cache_file_bytes(uint64_t entry_capacity) {
+    return sizeof(struct memo_cache_header) + (size_t)(entry_capacity / 2) * sizeof(struct memo_cache_tile) +
+           (size_t)entry_capacity * sizeof(struct memo_cache_entry);
+}
+
+/* Maps the cache at `path`. A missing or empty file is set up with tables
+   sized to fit `size` bytes; anything else must be a cache for `rule` and
+   is never overwritten. On failure `error` says why. The file is locked for
+   the life of the process. */
+static struct memo_cache *memo_cache_open(const char *path, size_t size, const struct life_rule *rule, char *error,
+                                          size_t error_size) {
+    int fd = open(path, O_RDWR | O_CREAT, 0600);
+    if (fd == -1) {
+        snprintf(error, error_size, "%s", strerror(errno));
+        return NULL;
+    }
+    struct stat st;
+    if (flock(fd, LOCK_EX | LOCK_NB) == -1 || fstat(fd, &st) == -1) {
+        snprintf(error, error_size, "%s", errno == EWOULDBLOCK ? "in use by another process" : strerror(errno));
+        close(fd);
+        return NULL;
+    }
+    char name[64];
+    life_rule_format(rule, name, sizeof(name));
+    struct memo_cache_header header;
+    uint64_t entry_capacity = 1024;
+    bool fresh = st.st_size == 0;
+    if (fresh) {
+        while (memo_cache_file_bytes(entry_capacity * 2) <= size) {
+            entry_capacity *= 2;
+        }
+        if (ftruncate(fd, (off_t)memo_cache_file_bytes(entry_capacity)) == -1) {
+            snprintf(error, error_size, "%s", strerror(errno));
+            close(fd);
+            return NULL;
+        }
+    } else {
+        bool usable = false;
+        if ((size_t)st.st_size < sizeof(header) || pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+            header.magic != MEMO_CACHE_MAGIC) {
+            snprintf(error, error_size, "not a memo cache file");
+        } else if (header.version != MEMO_CACHE_VERSION || header.tile_size != TILE_SIZE) {
+            snprintf(error, error_size, "written by an incompatible version");
+        } else if (strnlen(header.rule, sizeof(header.rule)) == sizeof(header.rule) || strcmp(header.rule, name) != 0) {
+            snprintf(error, error_size, "holds results for rule %.63s, not %s; use another file",
+                     strnlen(header.rule, sizeof(header.rule)) < sizeof(header.rule) ? header.rule : "?", name);
+        } else if (header.entry_capacity < 1024 || (header.entry_capacity & (header.entry_capacity - 1)) != 0 ||
+                   header.entry_capacity > UINT32_MAX || header.tile_capacity != header.entry_capacity / 2 ||
+                   (uint64_t)st.st_size != memo_cache_file_bytes(header.entry_capacity)) {
+            snprintf(error, error_size, "damaged header");
+        } else {
+            usable = true;
+        }
+        if (!usable) {
+            close(fd);
+            return NULL;
+        }
+        entry_capacity = header.entry_capacity;
+    }
+    struct memo_cache *cache = calloc(1, sizeof(*cache));
+    if (!cache) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    cache->fd = fd;
+    cache->bytes = memo_cache_file_bytes(entry_capacity);
+    cache->header = mmap(NULL, cache->bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (cache->header == MAP_FAILED) {
+        perror("memo cache");
+        exit(EXIT_FAILURE);
+    }
+    cache->tiles = (struct memo_cache_tile *)(cache->header + 1);
+    cache->entries = (struct memo_cache_entry *)(cache->tiles + entry_capacity / 2);
+    cache->rule = *rule;
+    if (fresh) {
+        cache->header->magic = MEMO_CACHE_MAGIC;
+        cache->header->version = MEMO_CACHE_VERSION;
+        cache->header->tile_size = TILE_SIZE;
+        memcpy(cache->header->rule, name, sizeof(name));
+        cache->header->tile_capacity = entry_capacity / 2;
+        cache->header->entry_capacity = entry_capacity;
+    }
+    return cache;
+}
+
+static void memo_cache_close(struct memo_cache *cache) {
+    if (!cache) {
+        return;
+    }
+    munmap(cache->header, cache->bytes);
+    close(cache->fd);
+    free(cache);
+}
+
+/* The file id of `rows`, adding it if `add` and there is room, or 0. The
+   file may have been damaged, so probes stop after one pass of the table. */
+static uint32_t memo_cache_tile_id(struct memo_cache *cache, const uint32_t *rows, uint64_t hash, bool add) {
+    uint64_t tag = hash | 1;
+    size_t capacity = (size_t)cache->header->tile_capacity;
+    size_t index = (size_t)(hash >> 1) & (capacity - 1);
+    for (size_t probes = 0; probes < capacity; ++probes) {
+        struct memo_cache_tile *tile = &cache->tiles[index];
+        if (tile->tag == 0) {
+            if (!add || cache->header->tile_count * 4 >= capacity * 3) {
+                return 0;
+            }
+            memcpy(tile->rows, rows, sizeof(tile->rows));
+            tile->tag = tag;
+            cache->header->tile_count++;
+            return (uint32_t)index + 1;
+        }
+        if (tile->tag == tag && memcmp(tile->rows, rows, sizeof(tile->rows)) == 0) {
+            return (uint32_t)index + 1;
+        }
+        index = (index + 1) & (capacity - 1);
+    }
+    return 0;
+}
+
+/* The entry for a neighbourhood, or the free slot it would go in, or NULL
+   if a damaged table has neither. */
+static struct memo_cache_entry *memo_cache_slot(const struct memo_cache *cache, const uint32_t *ids, int gens) {
+    size_t capacity = (size_t)cache->header->entry_capacity;
+    size_t index = tile_memo_hash(ids, gens) & (capacity - 1);
+    for (size_t probes = 0; probes < capacity; ++probes) {
+        struct memo_cache_entry *entry = &cache->entries[index];
+        if (!entry->used || (entry->gens == gens && memcmp(entry->ids, ids, sizeof(entry->ids)) == 0)) {
+            return entry;
+        }
+        index = (index + 1) & (capacity - 1);
+    }
+    return NULL;
+}
+
+/* Reads the result of stepping `around` from the file, if it is there.
+   Only reads, so planning tasks may call it concurrently. A result that
+   names no stored tile, or a tile whose rows no longer match its hash, is
+   treated as a miss. */
+static bool memo_cache_step(const struct memo_cache *cache, const struct tile_content *const around[9], int gens,
+                            uint32_t *rows, bool still[2], uint32_t *result_id) {
+    uint32_t ids[9];
+    for (int k = 0; k < 9; ++k) {
+        ids[k] = around[k] ? around[k]->cache_id : 0;
+        if (around[k] && (ids[k] == 0 || ids[k] == TILE_CACHE_UNKNOWN)) {
+            return false;
+        }
+    }
+    const struct memo_cache_entry *entry = memo_cache_slot(cache, ids, gens);
+    if (!entry || !entry->used || entry->still > 3) {
+        return false;
+    }
+    if (entry->result) {
+        if (entry->result > cache->header->tile_capacity) {
+            return false;
+        }
+        const struct memo_cache_tile *tile = &cache->tiles[entry->result - 1];
+        memcpy(rows, tile->rows, TILE_SIZE * sizeof(*rows));
+        if (tile->tag != (tile_content_hash(rows) | 1)) {
+            return false;
+        }
+    } else {
+        memset(rows, 0, TILE_SIZE * sizeof(*rows));
+    }
+    still[0] = entry->still & 1;
+    still[1] = entry->still & 2;
+    *result_id = entry->result;
+    return true;
+}
+
+static uint32_t memo_cache_content_id(struct memo_cache *cache, struct tile_content *content, bool add) {
+    if (content->cache_id == TILE_CACHE_UNKNOWN || (add && content->cache_id == 0)) {
+        content->cache_id = memo_cache_tile_id(cache, content->rows, content->hash, add);
+    }
+    return content->cache_id;
+}
+
+/* Writes a freshly stepped neighbourhood and its result to the file. */
+static void memo_cache_record(struct memo_cache *cache, struct tile_content *const around[9], int gens,
+                              struct tile_content *result, const bool still[2]) {
+    if (cache->header->entry_count * 4 >= cache->header->entry_capacity * 3) {
+        return;
+    }
+    uint32_t ids[9];
+    for (int k = 0; k < 9; ++k) {
+        ids[k] = around[k] ? memo_cache_content_id(cache, around[k], true) : 0;
+        if (around[k] && ids[k] == 0) {
+            return;
+        }
+    }
+    uint32_t result_id = result ? memo_cache_content_id(cache, result, true) : 0;
+    if (result && result_id == 0) {
+        return;
+    }
+    struct memo_cache_entry *entry = memo_cache_slot(cache, ids, gens);
+    if (!entry || entry->used) {
+        return;
+    }
+    memcpy(entry->ids, ids, sizeof(entry->ids));
+    entry->result = result_id;
+    entry->gens = (uint16_t)gens;
+    entry->still = (uint8_t)((still[0] ? 1 : 0) | (still[1] ? 2 : 0));
+    entry->used = 1;
+    cache->header->entry_count++;
+    cache->added++;
+}
+
+static void tile_map_link(struct tile_map *map, struct tile *tile) {
+    if ((map->size + 1) * 2 > map->capacity) {
+        tile_map_expand(map);
+    }
+    size_t index = tile_hash(map->capacity, tile->tx, tile->ty);
+    tile->next = map->buckets[index];
+    map->buckets[index] = tile;
+    map->size++;
+}
+
+/* `slot` is SIZE_MAX for tiles that are known not to change in this block;
+   they keep `content`. A candidate that added its memo entry steps it into
+   the job of the same index. */
+struct tile_candidate {
+    int tx;
+    int ty;
+    int node;
+    bool claimed;
+    size_t slot;
+    struct tile_content *content;
+};
+
+struct tile_step_job {
+    uint64_t hash;
+    struct tile_content *around[9];
+    uint32_t cache_result;
+    bool cached;
+    bool still[2];
+    uint32_t rows[TILE_SIZE];
+};
+
+#define TILE_PLAN_CHUNK 64
+
+/* A run of candidates planned by one task: each resolves its neighbourhood
+   to a memo slot, and whichever task claims a new slot steps it on the spot. */
+struct tile_plan_chunk {
+    struct tile_memo_entry *memo;
+    size_t memo_capacity;
+    const struct memo_cache *cache;
+    const struct tile_map *src;
+    const struct cell_set *changed;
+    const struct life_rule *rule;
+    int gens;
+    struct tile_candidate *candidates;
+    struct tile_step_job *jobs;
+    size_t begin;
+    size_t end;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t cache_hits;
+};
+
+static void tile_plan_chunk_run(void *arg) {
+    struct tile_plan_chunk *chunk = arg;
+    for (size_t i = chunk->begin; i < chunk->end; ++i) {
+        struct tile_candidate *candidate = &chunk->candidates[i];
+        const struct tile_content *around[9];
+        uint32_t ids[9];
+        bool quiet = chunk->changed != NULL;
+        for (int k = 0; k < 9; ++k) {
+            int nx = candidate->tx + k % 3 - 1;
+            int ny = candidate->ty + k / 3 - 1;
+            const struct tile *tile = tile_map_find(chunk->src, nx, ny);
+            around[k] = tile ? tile->content : NULL;
+            ids[k] = tile ? tile->content->id : 0;
+            quiet = quiet && !cell_set_contains(chunk->changed, nx, ny);
+        }
+        candidate->claimed = false;
+        if (quiet) {
+            candidate->slot = SIZE_MAX;
+            candidate->content = (struct tile_content *)around[4];
+            continue;
+        }
+        if (!tile_memo_claim(chunk->memo, chunk->memo_capacity, ids, chunk->gens, &candidate->slot)) {
+            chunk->hits++;
+            continue;
+        }
+        chunk->misses++;
+        candidate->claimed = true;
+        struct tile_step_job *job = &chunk->jobs[i];
+        job->cached = chunk->cache && memo_cache_step(chunk->cache, around, chunk->gens, job->rows, job->still, &job->cache_result);
+        if (job->cached) {
+            chunk->cache_hits++;
+        } else {
+            tile_step(around, job->rows, job->still, chunk->gens, chunk->rule);
+            for (int k = 0; k < 9; ++k) {
+                job->around[k] = (struct tile_content *)around[k];
+            }
+        }
+        job->hash = tile_content_hash(job->rows);
+    }
+}
+
+static int tile_region_node(const struct scheduler *sched, int tx, int ty) {
+    if (!sched || sched->node_count < 2) {
+        return 0;
+    }
+    uint64_t region = ((uint64_t)(uint32_t)(tx >> 3) << 32) ^ (uint32_t)(ty >> 3);
+    return (int)(mix64(region) % (uint64_t)sched->node_count);
+}
+
+/* Tiles that differ from the generation before (`changed`) and from the one
+   two before (`unsettled`). Settled still lifes are in neither set and
+   settled period-2 oscillators such as blinkers only in `changed`. */
+struct tile_changes {
+    struct cell_set changed;
+    struct cell_set unsettled;
+};
+
+static void tile_changes_init(struct tile_changes *changes, size_t capacity) {
+    cell_set_init(&changes->changed, capacity);
+    cell_set_init(&changes->unsettled, capacity);
+}
+
+static void tile_changes_destroy(struct tile_changes *changes) {
+    cell_set_destroy(&changes->changed);
+    cell_set_destroy(&changes->unsettled);
+}
+
+/* With `in`, the changes as of the block's first generation, a tile whose 3x3
+   neighbourhood holds no changed tile cannot change during the block, and
+   over an even number of generations neither can one with no unsettled
+   neighbour; such tiles keep their contents and only tiles and the
+   neighbours of changes are candidates. With `out`, the changes as of the
+   block's last generation are recorded there. */
+static void tile_map_step_block(struct tile_store *store, const struct tile_map *src, struct tile_map *dst, int gens,
+                                const struct life_rule *rule, struct scheduler *sched, const struct tile_changes *in,
+                                struct tile_changes *out) {
+    const struct cell_set *changed = in ? (gens % 2 == 0 ? &in->unsettled : &in->changed) : NULL;
+    /* Tasks read file ids of the contents but never look them up. */
+    struct memo_cache *cache = store->cache && life_rule_equal(&store->cache->rule, rule) ? store->cache : NULL;
+    if (cache) {
+        for (size_t i = 0; i < src->capacity; ++i) {
+            for (const struct tile *tile = src->buckets[i]; tile; tile = tile->next) {
+                memo_cache_content_id(cache, tile->content, false);
+            }
+        }
+    }
+    struct cell_set positions;
+    cell_set_init(&positions, MAX(src->capacity * 4, (size_t)INITIAL_HASH_CAPACITY));
+    int reach = changed ? 0 : 1;
+    for (size_t i = 0; i < src->capacity; ++i) {
+        for (const struct tile *tile = src->buckets[i]; tile; tile = tile->next) {
+            for (int ny = -reach; ny <= reach; ++ny) {
+                for (int nx = -reach; nx <= reach; ++nx) {
+                    cell_set_insert(&positions, tile->tx + nx, tile->ty + ny);
+                }
+            }
+        }
+    }
+    if (changed) {
+        struct cell_iterator it = cell_set_iter(changed);
+        int cx, cy;
+        while (cell_iter_next(&it, &cx, &cy)) {
+            for (int ny = -1; ny <= 1; ++ny) {
+                for (int nx = -1; nx <= 1; ++nx) {
+                    cell_set_insert(&positions, cx + nx, cy + ny);
+                }
+            }
+        }
+        /* Oscillating tiles may be empty in this phase but not the next. */
+        it = cell_set_iter(&in->changed);
+        while (cell_iter_next(&it, &cx, &cy)) {
+            cell_set_insert(&positions, cx, cy);
+        }
+    }
+
+    size_t count = cell_set_count(&positions);
+    struct tile_candidate *candidates = malloc(MAX(count, (size_t)1) * sizeof(*candidates));
+    struct tile_step_job *jobs = malloc(MAX(count, (size_t)1) * sizeof(*jobs));
+    if (!candidates || !jobs) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    int node_count = sched ? sched->node_count : 1;
+    size_t *node_begin = calloc((size_t)node_count + 1, sizeof(*node_begin));
+    if (!node_begin) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    struct cell_iterator it = cell_set_iter(&positions);
+    int tx, ty;
+    while (cell_iter_next(&it, &tx, &ty)) {
+        node_begin[tile_region_node(sched, tx, ty) + 1]++;
+    }
+    for (int node = 0; node < node_count; ++node) {
+        node_begin[node + 1] += node_begin[node];
+    }
+    /* Candidates are grouped by the node that owns their region. */
+    it = cell_set_iter(&positions);
+    while (cell_iter_next(&it, &tx, &ty)) {
+        int node = tile_region_node(sched, tx, ty);
+        struct tile_candidate *candidate = &candidates[node_begin[node]++];
+        candidate->tx = tx;
+        candidate->ty = ty;
+        candidate->node = node;
+    }
+    cell_set_destroy(&positions);
+    memmove(node_begin + 1, node_begin, (size_t)node_count * sizeof(*node_begin));
+    node_begin[0] = 0;
+
+    /* Planning and stepping run as tasks over runs of candidates, with the
+       memo as the shared result table: the first task to meet a
+       neighbourhood claims its slot and steps it, any later one reuses it.
+       Reserving up front keeps the table from filling up or moving. */
+    tile_store_reserve(store, count);
+    size_t chunk_count = 0;
+    struct tile_plan_chunk *chunks = malloc((count / TILE_PLAN_CHUNK + (size_t)node_count) * sizeof(*chunks));
+    if (!chunks) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    for (int node = 0; node < node_count; ++node) {
+        for (size_t begin = node_begin[node]; begin < node_begin[node + 1]; begin += TILE_PLAN_CHUNK) {
+            struct tile_plan_chunk *chunk = &chunks[chunk_count++];
+            chunk->memo = store->memo;
+            chunk->memo_capacity = store->memo_capacity;
+            chunk->cache = cache;
+            chunk->src = src;
+            chunk->changed = changed;
+            chunk->rule = rule;
+            chunk->gens = gens;
+            chunk->candidates = candidates;
+            chunk->jobs = jobs;
+            chunk->begin = begin;
+            chunk->end = MIN(begin + TILE_PLAN_CHUNK, node_begin[node + 1]);
+            chunk->hits = 0;
+            chunk->misses = 0;
+            chunk->cache_hits = 0;
+        }
+    }
+    if (!sched || sched->worker_count < 2) {
+        for (size_t i = 0; i < chunk_count; ++i) {
+            tile_plan_chunk_run(&chunks[i]);
+        }
+    } else {
+        /* Each node's chunks are handed out in contiguous runs to that node's
+           workers; stealing rebalances whatever this static split gets wrong. */
+        struct task_group group;
+        atomic_init(&group.pending, 0);
+        size_t begin = 0;
+        while (begin < chunk_count) {
+            int node = candidates[chunks[begin].begin].node;
+            size_t end = begin;
+            while (end < chunk_count && candidates[chunks[end].begin].node == node) {
+                end++;
+            }
+            int first = sched->node_first_worker[node];
+            int workers = sched->node_first_worker[node + 1] - first;
+            for (size_t i = begin; i < end; ++i) {
+                int worker = first + (int)((i - begin) * (size_t)workers / (end - begin));
+                scheduler_spawn_on(sched, worker, &group, tile_plan_chunk_run, &chunks[i]);
+            }
+            begin = end;
+        }
+        scheduler_wait(sched, &group);
+    }
+    for (size_t i = 0; i < chunk_count; ++i) {
+        store->memo_hits += chunks[i].hits;
+        store->memo_misses += chunks[i].misses;
+        store->memo_size += chunks[i].misses;
+        if (cache) {
+            store->cache->lookups += chunks[i].misses;
+            store->cache->hits += chunks[i].cache_hits;
+        }
+    }
+    free(chunks);
+    free(node_begin);
+
+    /* Interning stays on this thread; the hashes were taken by the tasks. */
+    for (size_t i = 0; i < count; ++i) {
+        if (candidates[i].claimed) {
+            struct tile_memo_entry *entry = &store->memo[candidates[i].slot];
+            entry->result = tile_store_intern_hashed(store, jobs[i].rows, jobs[i].hash);
+            memcpy(entry->still, jobs[i].still, sizeof(entry->still));
+            if (cache && jobs[i].cached) {
+                if (entry->result) {
+                    entry->result->cache_id = jobs[i].cache_result;
+                }
+            } else if (cache) {
+                memo_cache_record(store->cache, jobs[i].around, gens, entry->result, entry->still);
+            }
+        }
+        if (candidates[i].slot != SIZE_MAX) {
+            store->memo[candidates[i].slot].recent = true;
+        }
+    }
+
+    if (sched) {
+        memset(sched->node_tile_bytes, 0, (size_t)sched->node_count * sizeof(size_t));
+    }
+    for (size_t i = 0; i < count; ++i) {
+        int ctx = candidates[i].tx;
+        int cty = candidates[i].ty;
+        bool copied = candidates[i].slot == SIZE_MAX;
+        struct tile_content *result = copied ? candidates[i].content : store->memo[candidates[i].slot].result;
+        if (out) {
+            /* A single generation cannot see two back; a tile that changed in
+               either of the last two generations may differ. */
+            bool was_changed = in && cell_set_contains(&in->changed, ctx, cty);
+            const bool *still = copied ? NULL : store->memo[candidates[i].slot].still;
+            if (copied ? was_changed : !still[0]) {
+                cell_set_insert(&out->changed, ctx, cty);
+            }
+            if (!copied && (gens >= 2 ? !still[1] : !still[0] || was_changed || !in)) {
+                cell_set_insert(&out->unsettled, ctx, cty);
+            }
+        }
+        if (!result) {
+            continue;
+        }
+        struct tile *tile = arena_alloc(&dst->arena, sizeof(*tile));
+        tile->tx = candidates[i].tx;
+        tile->ty = candidates[i].ty;
+        tile->content = result;
+        tile_map_link(dst, tile);
+        if (sched) {
+            sched->node_tile_bytes[candidates[i].node] += sizeof(struct tile) + sizeof(struct tile_content);
+        }
+    }
+    if (sched) {
+        for (int node = 0; node < sched->node_count; ++node) {
+            sched->node_peak_tile_bytes[node] = MAX(sched->node_peak_tile_bytes[node], sched->node_tile_bytes[node]);
+        }
+    }
+    free(candidates);
+    free(jobs);
+}
+
+#define COLD_INITIAL_SLOTS 4096
+#define COLD_CODE_MAX (2 * TILE_SIZE * sizeof(uint32_t) + 8)
+
+/* A cold tile's census figures in one phase, relative to its corner. */
+struct cold_phase {
+    uint16_t population;
+    uint16_t sum_x;
+    uint16_t sum_y;
+    uint8_t min_x;
+    uint8_t min_y;
+    uint8_t max_x;
+    uint8_t max_y;
+};
+
+/* Kept in RAM for every cold tile so that counting never touches the file.
+   phases[] is indexed by generation parity, like the slot's rows; `fresh`
+   marks tiles evicted during the current stepping call. With compression,
+   `slot` is the offset of the tile's code in the heap. */
+struct cold_entry {
+    uint64_t key;
+    /* A slot of the file, or with compression a byte offset into the heap. */
+    uint64_t slot;
+    uint16_t length;
+    bool fresh;
+    bool used;
+    struct cold_phase phases[2];
+};
+
+/* A cold tile's contents at the start of the current stepping call, kept
+   when it is first faulted back in to tell its surviving cells from births. */
+struct cold_fault {
+    int tx;
+    int ty;
+    uint32_t rows[TILE_SIZE];
+};
+
+/* Out-of-core storage for settled tiles. A tile with nothing unsettled within
+   two tiles of it cannot change except for flipping between two phases, and
+   neither can any tile whose window reads it, so both of its phases are
+   written to a slot of a memory-mapped file and it leaves the live set; the
+   kernel pages slots out under memory pressure. As soon as an unsettled tile
+   comes within two tiles it is faulted back in, in the phase of the current
+   generation. `changes` is carried from one stepping call to the next while
+   `history` is set and the generation and rule still match.
+   The compressed backend keeps the tiles in RAM instead, run-length coded
+   back to back in `heap`, which is compacted once half of it is dead. */
+struct cold_store {
+    bool enabled;
+    bool compressed;
+    int fd;
+    uint32_t (*slots)[2][TILE_SIZE];
+    size_t slot_capacity;
+    size_t slot_count;
+    uint32_t *free_slots;
+    size_t free_count;
+    uint8_t *heap;
+    size_t heap_size;
+    size_t heap_capacity;
+    size_t heap_dead;
+    struct cold_entry *index;
+    size_t index_capacity;
+    size_t size;
+    size_t peak_size;
+    /* Cold cells at even and at odd generations, kept as tiles come and go. */
+    size_t population[2];
+    struct tile_changes changes;
+    bool history;
+    size_t generation;
+    struct life_rule rule;
+    size_t start_generation;
+    struct cold_fault *faults;
+    size_t fault_count;
+    size_t fault_capacity;
+    struct count_map faulted;
+    uint64_t evictions;
+    uint64_t fault_ins;
+};
+
+static void cold_store_init(struct cold_store *store) {
+    memset(store, 0, sizeof(*store));
+    store->fd = -1;
+    store->rule = CONWAY_RULE;
+}
+
+static bool cold_store_enabled(const struct cold_store *store) {
+    return store->enabled;
+}
+
+/* A NULL path selects the compressed in-memory backend. */
+static bool cold_store_open(struct cold_store *store, const char *path) {
+    if (path) {
+        /* The file is scratch space: it must not exist yet, and its name goes
+           away at once so nothing is left behind however the run ends. */
+        store->fd = open(path, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (store->fd == -1) {
+            return false;
+        }
+        unlink(path);
+        store->slot_capacity = COLD_INITIAL_SLOTS;
+        size_t bytes = store->slot_capacity * sizeof(*store->slots);
+        if (ftruncate(store->fd, (off_t)bytes) == -1) {
+            close(store->fd);
+            store->fd = -1;
+            return false;
+        }
+        store->slots = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, store->fd, 0);
+        store->free_slots = malloc(store->slot_capacity * sizeof(*store->free_slots));
+        if (store->slots == MAP_FAILED || !store->free_slots) {
+            perror("cold store");
+            exit(EXIT_FAILURE);
+        }
+    } else {
+        store->compressed = true;
+        store->heap_capacity = (size_t)64 << 10;
+        store->heap = malloc(store->heap_capacity);
+    }
+    store->index_capacity = COLD_INITIAL_SLOTS;
+    store->index = calloc(store->index_capacity, sizeof(*store->index));
+    if ((store->compressed && !store->heap) || !store->index) {
+        perror("cold store");
+        exit(EXIT_FAILURE);
+    }
+    store->enabled = true;
+    tile_changes_init(&store->changes, INITIAL_HASH_CAPACITY);
+    count_map_init(&store->faulted, COUNT_HASH_CAPACITY);
+    return true;
+}
+
+static void cold_store_reset(struct cold_store *store) {
+    if (!cold_store_enabled(store)) {
+        return;
+    }
+    memset(store->index, 0, store->index_capacity * sizeof(*store->index));
+    store->size = 0;
+    store->population[0] = 0;
+    store->population[1] = 0;
+    store->slot_count = 0;
+    store->free_count = 0;
+    store->heap_size = 0;
+    store->heap_dead = 0;
+    store->history = false;
+    cell_set_clear(&store->changes.changed);
+    cell_set_clear(&store->changes.unsettled);
+}
+
+static void cold_store_destroy(struct cold_store *store) {
+    if (!cold_store_enabled(store)) {
+        return;
+    }
+    if (!store->compressed) {
+        munmap(store->slots, store->slot_capacity * sizeof(*store->slots));
+        close(store->fd);
+    }
+    free(store->free_slots);
+    free(store->heap);
+    free(store->index);
+    free(store->faults);
+    tile_changes_destroy(&store->changes);
+    count_map_destroy(&store->faulted);
+    store->fd = -1;
+    store->enabled = false;
+}
+
+/* Bytes holding cold tiles: the file, or the live part of the heap. */
+static size_t cold_store_bytes(const struct cold_store *store) {
+    return store->compressed ? store->heap_size - store->heap_dead : store->slot_capacity * sizeof(*store->slots);
+}
+
+static size_t cold_store_population(const struct cold_store *store, size_t generation) {
+    return store->population[generation & 1];
+}
+
+static struct cold_entry *cold_store_slot(struct cold_entry *index, size_t capacity, uint64_t key) {
+    size_t mask = capacity - 1;
+    size_t i = (size_t)mix64(key) & mask;
+    while (index[i].used && index[i].key != key) {
+        i = (i + 1) & mask;
+    }
+    return &index[i];
+}
+
+static struct cold_entry *cold_store_find(const struct cold_store *store, int tx, int ty) {
+    if (store->size == 0) {
+        return NULL;
+    }
+    struct cold_entry *entry = cold_store_slot(store->index, store->index_capacity, cell_key(tx, ty));
+    return entry->used ? entry : NULL;
+}
+
+/* Tile codes start with a flag byte (1 when both phases are equal and only
+   one is coded), followed by tokens over the bytes of the rows: 0x80 | (n - 1)
+   stands for n zero bytes and n - 1 for n literal bytes, n <= 128. Ash is
+   mostly zero bytes, so a still life tile codes to a handful of bytes. */
+static size_t cold_code_encode(const uint32_t *rows, uint8_t *code) {
+    bool single = memcmp(rows, rows + TILE_SIZE, TILE_SIZE * sizeof(*rows)) == 0;
+    uint8_t bytes[2 * TILE_SIZE * sizeof(uint32_t)];
+    size_t count = single ? sizeof(bytes) / 2 : sizeof(bytes);
+    memcpy(bytes, rows, count);
+    size_t length = 0;
+    code[length++] = single ? 1 : 0;
+    size_t i = 0;
+    while (i < count) {
+        size_t run = 0;
+        while (i + run < count && run < 128 && bytes[i + run] == 0) {
+            run++;
+        }
+        if (run > 0) {
+            code[length++] = (uint8_t)(0x80 | (run - 1));
+            i += run;
+            continue;
+        }
+        /* A lone zero byte between literals is cheaper kept in the literal. */
+        size_t literal = 1;
+        while (i + literal < count && literal < 128 &&
+               (bytes[i + literal] != 0 || (i + literal + 1 < count && bytes[i + literal + 1] != 0))) {
+            literal++;
+        }
+        code[length++] = (uint8_t)(literal - 1);
+        memcpy(code + length, bytes + i, literal);
+        length += literal;
+        i += literal;
+    }
+    return length;
+}
+
+static void cold_code_decode(const uint8_t *code, uint32_t rows[2][TILE_SIZE]) {
+    uint8_t bytes[2 * TILE_SIZE * sizeof(uint32_t)];
+    size_t count = code[0] ? sizeof(bytes) / 2 : sizeof(bytes);
+    size_t i = 0;
+    const uint8_t *p = code + 1;
+    while (i < count) {
+        size_t n = (size_t)(*p & 0x7f) + 1;
+        if (*p++ & 0x80) {
+            memset(bytes + i, 0, n);
+        } else {
+            memcpy(bytes + i, p, n);
+            p += n;
+        }
+        i += n;
+    }
+    memcpy(rows, bytes, count);
+    if (code[0]) {
+        memcpy(rows[1], rows[0], sizeof(rows[0]));
+    }
+}
+
+static void cold_store_load(const struct cold_store *store, const struct cold_entry *entry, uint32_t rows[2][TILE_SIZE]) {
+    if (store->compressed) {
+        cold_code_decode(store->heap + entry->slot, rows);
+    } else {
+        memcpy(rows, store->slots[entry->slot], sizeof(store->slots[entry->slot]));
+    }
+}
+
+static void cold_store_read(const struct cold_store *store, const struct cold_entry *entry, size_t generation, uint32_t *rows) {
+    if (store->compressed) {
+        uint32_t both[2][TILE_SIZE];
+        cold_code_decode(store->heap + entry->slot, both);
+        memcpy(rows, both[generation & 1], sizeof(both[0]));
+    } else {
+        memcpy(rows, store->slots[entry->slot][generation & 1], sizeof(store->slots[entry->slot][0]));
+    }
+}
+
+/* Appends a tile code to the heap, first squeezing out dead codes when they
+   make up half of it. */
+static uint64_t cold_store_append(struct cold_store *store, const uint8_t *code, size_t length) {
+    if (store->heap_dead * 2 > store->heap_size && store->heap_size > ((size_t)64 << 10)) {
+        uint8_t *heap = malloc(store->heap_capacity);
+        if (!heap) {
+            perror("malloc");
+            exit(EXIT_FAILURE);
+        }
+        size_t size = 0;
+        for (size_t i = 0; i < store->index_capacity; ++i) {
+            struct cold_entry *entry = &store->index[i];
+            if (entry->used) {
+                memcpy(heap + size, store->heap + entry->slot, entry->length);
+                entry->slot = size;
+                size += entry->length;
+            }
+        }
+        free(store->heap);
+        store->heap = heap;
+        store->heap_size = size;
+        store->heap_dead = 0;
+    }
+    if (store->heap_size + length > store->heap_capacity) {
+        store->heap_capacity = MAX(store->heap_capacity * 2, store->heap_size + length);
+        store->heap = realloc(store->heap, store->heap_capacity);
+        if (!store->heap) {
+            perror("realloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+    memcpy(store->heap + store->heap_size, code, length);
+    store->heap_size += length;
+    return store->heap_size - length;
+}
+
+static uint32_t cold_store_alloc_slot(struct cold_store *store) {
+    if (store->free_count > 0) {
+        return store->free_slots[--store->free_count];
+    }
+    if (store->slot_count == store->slot_capacity) {
+        size_t old_bytes = store->slot_capacity * sizeof(*store->slots);
+        size_t capacity = store->slot_capacity * 2;
+        uint32_t *free_slots = realloc(store->free_slots, capacity * sizeof(*free_slots));
+        if (!free_slots || ftruncate(store->fd, (off_t)(old_bytes * 2)) == -1) {
+            perror("cold store");
+            exit(EXIT_FAILURE);
+        }
+        void *slots = mremap(store->slots, old_bytes, old_bytes * 2, MREMAP_MAYMOVE);
+        if (slots == MAP_FAILED) {
+            perror("mremap");
+            exit(EXIT_FAILURE);
+        }
+        store->slots = slots;
+        store->free_slots = free_slots;
+        store->slot_capacity = capacity;
+    }
+    return (uint32_t)store->slot_count++;
+}
+
+static void cold_phase_measure(struct cold_phase *phase, const uint32_t *rows) {
+    memset(phase, 0, sizeof(*phase));
+    phase->min_x = phase->min_y = TILE_SIZE;
+    for (int r = 0; r < TILE_SIZE; ++r) {
+        uint32_t bits = rows[r];
+        if (!bits) {
+            continue;
+        }
+        phase->population += (uint16_t)__builtin_popcount(bits);
+        phase->min_y = (uint8_t)MIN(phase->min_y, r);
+        phase->max_y = (uint8_t)r;
+        phase->min_x = (uint8_t)MIN(phase->min_x, __builtin_ctz(bits));
+        phase->max_x = (uint8_t)MAX(phase->max_x, 31 - __builtin_clz(bits));
+        phase->sum_y += (uint16_t)(r * __builtin_popcount(bits));
+        for (; bits; bits &= bits - 1) {
+            phase->sum_x += (uint16_t)__builtin_ctz(bits);
+        }
+    }
+}
+
+/* `rows` holds the tile's contents at even and at odd generations. */
+static void cold_store_put(struct cold_store *store, int tx, int ty, uint32_t rows[2][TILE_SIZE]) {
+    if ((store->size + 1) * 4 > store->index_capacity * 3) {
+        size_t capacity = store->index_capacity * 2;
+        struct cold_entry *index = calloc(capacity, sizeof(*index));
+        if (!index) {
+            perror("calloc");
+            exit(EXIT_FAILURE);
+        }
+        for (size_t i = 0; i < store->index_capacity; ++i) {
+            if (store->index[i].used) {
+                *cold_store_slot(index, capacity, store->index[i].key) = store->index[i];
+            }
+        }
+        free(store->index);
+        store->index = index;
+        store->index_capacity = capacity;
+    }
+    uint64_t slot;
+    uint8_t code[COLD_CODE_MAX];
+    size_t length = 0;
+    if (store->compressed) {
+        length = cold_code_encode(rows[0], code);
+        slot = cold_store_append(store, code, length);
+    } else {
+        slot = cold_store_alloc_slot(store);
+        memcpy(store->slots[slot], rows, sizeof(store->slots[slot]));
+    }
+    struct cold_entry *entry = cold_store_slot(store->index, store->index_capacity, cell_key(tx, ty));
+    entry->key = cell_key(tx, ty);
+    entry->used = true;
+    entry->fresh = true;
+    entry->slot = slot;
+    entry->length = (uint16_t)length;
+    cold_phase_measure(&entry->phases[0], rows[0]);
+    cold_phase_measure(&entry->phases[1], rows[1]);
+    store->population[0] += entry->phases[0].population;
+    store->population[1] += entry->phases[1].population;
+    store->size++;
+    store->peak_size = MAX(store->peak_size, store->size);
+    store->evictions++;
+}
+
+/* Copies the tile out of the store and removes it, with the same backward
+   shift as cell_set_remove. */
+static void cold_store_take(struct cold_store *store, struct cold_entry *entry, uint32_t rows[2][TILE_SIZE]) {
+    cold_store_load(store, entry, rows);
+    if (store->compressed) {
+        store->heap_dead += entry->length;
+    } else {
+        store->free_slots[store->free_count++] = (uint32_t)entry->slot;
+    }
+    store->population[0] -= entry->phases[0].population;
+    store->population[1] -= entry->phases[1].population;
+    store->size--;
+    size_t mask = store->index_capacity - 1;
+    size_t hole = (size_t)(entry - store->index);
+    for (size_t j = (hole + 1) & mask; store->index[j].used; j = (j + 1) & mask) {
+        size_t home = (size_t)mix64(store->index[j].key) & mask;
+        if (((j - home) & mask) >= ((j - hole) & mask)) {
+            store->index[hole] = store->index[j];
+            hole = j;
+        }
+    }
+    store->index[hole].used = false;
+}
+
+static void cold_store_fault(struct cold_store *store, struct cold_entry *entry, size_t generation, struct tile_store *contents,
+                             struct tile_map *tiles) {
+    int tx = cell_key_x(entry->key);
+    int ty = cell_key_y(entry->key);
+    uint32_t rows[2][TILE_SIZE];
+    bool fresh = entry->fresh;
+    cold_store_take(store, entry, rows);
+    store->fault_ins++;
+    struct count_entry *seen = count_map_get(&store->faulted, tx, ty);
+    if (seen->count == 0 && fresh) {
+        seen->count = -1;
+    } else if (seen->count == 0) {
+        if (store->fault_count == store->fault_capacity) {
+            store->fault_capacity = MAX(store->fault_capacity * 2, (size_t)64);
+            store->faults = realloc(store->faults, store->fault_capacity * sizeof(*store->faults));
+            if (!store->faults) {
+                perror("realloc");
+                exit(EXIT_FAILURE);
+            }
+        }
+        struct cold_fault *fault = &store->faults[store->fault_count++];
+        fault->tx = tx;
+        fault->ty = ty;
+        memcpy(fault->rows, rows[store->start_generation & 1], sizeof(fault->rows));
+        seen->count = (int)store->fault_count;
+    }
+    struct tile_content *content = tile_store_intern(contents, rows[generation & 1]);
+    if (content) {
+        tile_map_get(tiles, tx, ty)->content = content;
+    }
+}
+
+static void cold_store_fault_all(struct cold_store *store, size_t generation, struct tile_store *contents, struct tile_map *tiles) {
+    /* Removal shifts later entries back into the freed slot, never past it. */
+    for (size_t i = 0; i < store->index_capacity && store->size > 0; ++i) {
+        while (store->index[i].used) {
+            cold_store_fault(store, &store->index[i], generation, contents, tiles);
+        }
+    }
+}
+
+/* Starts a stepping call. Without a usable history every cold tile comes
+   back, since any of them may be next to a change. */
+static void cold_store_begin(struct cold_store *store, size_t generation, const struct life_rule *rule,
+                             struct tile_store *contents, struct tile_map *tiles) {
+    store->start_generation = generation;
+    store->fault_count = 0;
+    memset(store->faulted.slots, 0, store->faulted.capacity * sizeof(*store->faulted.slots));
+    store->faulted.size = 0;
+    if (store->history && store->generation == generation && life_rule_equal(&store->rule, rule)) {
+        return;
+    }
+    store->history = false;
+    cell_set_clear(&store->changes.changed);
+    cell_set_clear(&store->changes.unsettled);
+    cold_store_fault_all(store, generation, contents, tiles);
+}
+
+/* Faults in the cold tiles within two tiles of `around`, optionally
+   recording that neighbourhood in `near`. */
+static void cold_store_fault_near(struct cold_store *store, const struct cell_set *around, size_t generation,
+                                  struct tile_store *contents, struct tile_map *tiles, struct cell_set *near) {
+    struct cell_iterator it = cell_set_iter(around);
+    int cx, cy;
+    while (cell_iter_next(&it, &cx, &cy)) {
+        for (int ny = -2; ny <= 2; ++ny) {
+            for (int nx = -2; nx <= 2; ++nx) {
+                if (near) {
+                    cell_set_insert(near, cx + nx, cy + ny);
+                }
+                struct cold_entry *entry = cold_store_find(store, cx + nx, cy + ny);
+                if (entry) {
+                    cold_store_fault(store, entry, generation, contents, tiles);
+                }
+            }
+        }
+    }
+}
+
+/* Runs at every block boundary once `changes` is current: faults in the cold
+   tiles within two tiles of an unsettled one and evicts every other tile.
+   A tile that still flips between two phases is stepped once more here to
+   get its other phase. */
+static void cold_store_settle(struct cold_store *store, size_t generation, const struct life_rule *rule,
+                              struct tile_store *contents, struct tile_map *tiles) {
+    struct cell_set near;
+    cell_set_init(&near, cell_set_count(&store->changes.unsettled) * 32);
+    cold_store_fault_near(store, &store->changes.unsettled, generation, contents, tiles, &near);
+    for (size_t i = 0; i < tiles->capacity; ++i) {
+        struct tile **link = &tiles->buckets[i];
+        while (*link) {
+            struct tile *tile = *link;
+            if (cell_set_contains(&near, tile->tx, tile->ty)) {
+                link = &tile->next;
+                continue;
+            }
+            uint32_t rows[2][TILE_SIZE];
+            memcpy(rows[generation & 1], tile->content->rows, sizeof(rows[0]));
+            if (cell_set_contains(&store->changes.changed, tile->tx, tile->ty)) {
+                struct tile_content cold_around[9];
+                const struct tile_content *around[9];
+                for (int n = 0; n < 9; ++n) {
+                    int nx = tile->tx + n % 3 - 1;
+                    int ny = tile->ty + n / 3 - 1;
+                    const struct tile *neighbour = tile_map_find(tiles, nx, ny);
+                    const struct cold_entry *entry = neighbour ? NULL : cold_store_find(store, nx, ny);
+                    around[n] = neighbour ? neighbour->content : NULL;
+                    if (entry) {
+                        cold_store_read(store, entry, generation, cold_around[n].rows);
+                        around[n] = &cold_around[n];
+                    }
+                }
+                bool still[2];
+                tile_step(around, rows[(generation + 1) & 1], still, 1, rule);
+            } else {
+                memcpy(rows[(generation + 1) & 1], tile->content->rows, sizeof(rows[0]));
+            }
+            cold_store_put(store, tile->tx, tile->ty, rows);
+            *link = tile->next;
+            tiles->size--;
+        }
+    }
+    cell_set_destroy(&near);
+}
+
+static void life_census_add_block(struct life_census *census, const struct cold_entry *entry, size_t generation) {
+    const struct cold_phase *phase = &entry->phases[generation & 1];
+    if (phase->population == 0) {
+        return;
+    }
+    int x0 = cell_key_x(entry->key) * TILE_SIZE;
+    int y0 = cell_key_y(entry->key) * TILE_SIZE;
+    if (census->population == 0) {
+        census->min_x = x0 + phase->min_x;
+        census->max_x = x0 + phase->max_x;
+        census->min_y = y0 + phase->min_y;
+        census->max_y = y0 + phase->max_y;
+    } else {
+        census->min_x = MIN(census->min_x, x0 + phase->min_x);
+        census->max_x = MAX(census->max_x, x0 + phase->max_x);
+        census->min_y = MIN(census->min_y, y0 + phase->min_y);
+        census->max_y = MAX(census->max_y, y0 + phase->max_y);
+    }
+    census->population += phase->population;
+    census->sum_x += (int64_t)x0 * phase->population + phase->sum_x;
+    census->sum_y += (int64_t)y0 * phase->population + phase->sum_y;
+}
+
+static bool cold_fault_had(const struct cold_store *store, int x, int y) {
+    int tx = tile_coord(x);
+    int ty = tile_coord(y);
+    const struct count_entry *seen = count_map_slot((struct count_map *)&store->faulted, cell_key(tx, ty));
+    if (!seen->used || seen->count <= 0) {
+        return false;
+    }
+    const struct cold_fault *fault = &store->faults[seen->count - 1];
+    return (fault->rows[y - ty * TILE_SIZE] >> (x - tx * TILE_SIZE)) & 1u;
+}
+
+/* Adds the cold tiles at `generation` to a census of the in-memory tiles
+   taken against `previous`. Those counts hold every cell of a tile faulted in
+   during the call as a birth, so the ones that were alive in the cold copy
+   are taken back; tiles evicted during the call are checked cell by cell. */
+static void cold_store_census(struct cold_store *store, struct life_census *census, const struct cell_set *previous,
+                              const struct tile_map *tiles, size_t generation) {
+    for (size_t i = 0; i < store->fault_count; ++i) {
+        const struct cold_fault *fault = &store->faults[i];
+        const struct tile *tile = tile_map_find(tiles, fault->tx, fault->ty);
+        for (int r = 0; tile && r < TILE_SIZE; ++r) {
+            uint32_t bits = tile->content->rows[r] & fault->rows[r];
+            census->births -= (size_t)__builtin_popcount(bits);
+            for (; bits; bits &= bits - 1) {
+                census->change_sum_x -= fault->tx * TILE_SIZE + __builtin_ctz(bits);
+                census->change_sum_y -= fault->ty * TILE_SIZE + r;
+            }
+        }
+    }
+    for (size_t i = 0; i < store->index_capacity; ++i) {
+        struct cold_entry *entry = &store->index[i];
+        if (!entry->used) {
+            continue;
+        }
+        if (!entry->fresh) {
+            life_census_add_block(census, entry, generation);
+            continue;
+        }
+        entry->fresh = false;
+        uint32_t rows[TILE_SIZE];
+        cold_store_read(store, entry, generation, rows);
+        for (int r = 0; r < TILE_SIZE; ++r) {
+            for (uint32_t bits = rows[r]; bits; bits &= bits - 1) {
+                int x = cell_key_x(entry->key) * TILE_SIZE + __builtin_ctz(bits);
+                int y = cell_key_y(entry->key) * TILE_SIZE + r;
+                life_census_add_cell(census, x, y, !cell_set_contains(previous, x, y) && !cold_fault_had(store, x, y));
+            }
+        }
+    }
+}
+
+/* Moves every cold tile back into `live`; the census already counts them. */
+static void cold_store_thaw(struct cold_store *store, struct cell_set *live, size_t generation) {
+    for (size_t i = 0; i < store->index_capacity && store->size > 0; ++i) {
+        struct cold_entry *entry = &store->index[i];
+        while (entry->used) {
+            int tx = cell_key_x(entry->key);
+            int ty = cell_key_y(entry->key);
+            uint32_t rows[2][TILE_SIZE];
+            cold_store_take(store, entry, rows);
+            for (int r = 0; r < TILE_SIZE; ++r) {
+                for (uint32_t bits = rows[generation & 1][r]; bits; bits &= bits - 1) {
+                    cell_set_insert(live, tx * TILE_SIZE + __builtin_ctz(bits), ty * TILE_SIZE + r);
+                }
+            }
+        }
+    }
+}
+
+#define PHASE_HISTORY 12
+#define PHASE_BACKOFF 48
+
+/* The last PHASE_HISTORY generations of one tile, indexed by generation
+   modulo PHASE_HISTORY, as seen by the one-generation hash stepper.
+   `period` is the smallest p in 1..4 with which the whole history repeats
+   (0 if none). Twelve generations cover every lcm of those periods. */
+struct tile_phase {
+    int tx;
+    int ty;
+    int period;
+    int empty_run;
+    int lag;
+    bool skip;
+    uint64_t hashes[PHASE_HISTORY];
+    uint32_t rows[PHASE_HISTORY][TILE_SIZE];
+    struct tile_phase *next;
+};
+
+/* Tracks every tile that had live cells in the last PHASE_HISTORY
+   generations; tiles outside the map have been empty for at least that
+   long. The history is only trusted after `recorded` consecutive steps of
+   the same rule from `generation`, and life_state_recount() (called after
+   any outside edit of the live set) forgets it. Recording costs a lookup
+   per live cell, so while too few tiles are periodic to pay for that it is
+   paused until `resume`. */
+struct tile_phase_map {
+    struct tile_phase **buckets;
+    size_t capacity;
+    size_t size;
+    size_t recorded;
+    size_t generation;
+    size_t skipped;
+    size_t active_cells;
+    size_t resume;
+    bool paused;
+    struct life_rule rule;
+};
+
+static void tile_phase_map_init(struct tile_phase_map *map) {
+    memset(map, 0, sizeof(*map));
+    map->rule = CONWAY_RULE;
+}
+
+static void tile_phase_map_reset(struct tile_phase_map *map) {
+    for (size_t i = 0; i < map->capacity; ++i) {
+        struct tile_phase *node = map->buckets[i];
+        while (node) {
+            struct tile_phase *next = node->next;
+            free(node);
+            node = next;
+        }
+        map->buckets[i] = NULL;
+    }
+    map->size = 0;
+    map->recorded = 0;
+    map->skipped = 0;
+    map->resume = 0;
+}
+
+static void tile_phase_map_destroy(struct tile_phase_map *map) {
+    tile_phase_map_reset(map);
+    free(map->buckets);
+    map->buckets = NULL;
+    map->capacity = 0;
+}
+
+static struct tile_phase *tile_phase_find(const struct tile_phase_map *map, int tx, int ty) {
+    if (map->size == 0) {
+        return NULL;
+    }
+    struct tile_phase *node = map->buckets[tile_hash(map->capacity, tx, ty)];
+    while (node && (node->tx != tx || node->ty != ty)) {
+        node = node->next;
+    }
+    return node;
+}
+
+static void tile_phase_map_expand(struct tile_phase_map *map) {
+    size_t new_capacity = MAX(map->capacity * 2, (size_t)TILE_HASH_CAPACITY);
+    struct tile_phase **new_buckets = calloc(new_capacity, sizeof(*new_buckets));
+    if (!new_buckets) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < map->capacity; ++i) {
+        struct tile_phase *node = map->buckets[i];
+        while (node) {
+            struct tile_phase *next = node->next;
+            size_t index = tile_hash(new_capacity, node->tx, node->ty);
+            node->next = new_buckets[index];
+            new_buckets[index] = node;
+            node = next;
+        }
+    }
+    free(map->buckets);
+    map->buckets = new_buckets;
+    map->capacity = new_capacity;
+}
+
+static struct tile_phase *tile_phase_get(struct tile_phase_map *map, int tx, int ty) {
+    struct tile_phase *found = tile_phase_find(map, tx, ty);
+    if (found) {
+        return found;
+    }
+    if ((map->size + 1) * 2 > map->capacity) {
+        tile_phase_map_expand(map);
+    }
+    /* A tile that is new to the map was empty for its whole history. */
+    struct tile_phase *phase = calloc(1, sizeof(*phase));
+    if (!phase) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    counter_add(&counters.allocations, 1);
+    phase->tx = tx;
+    phase->ty = ty;
+    uint64_t empty = tile_content_hash(phase->rows[0]);
+    for (int i = 0; i < PHASE_HISTORY; ++i) {
+        phase->hashes[i] = empty;
+    }
+    size_t index = tile_hash(map->capacity, tx, ty);
+    phase->next = map->buckets[index];
+    map->buckets[index] = phase;
+    map->size++;
+    return phase;
+}
+
+static int gcd_int(int a, int b) {
+    while (b) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/* Marks the tiles whose next generation can be copied from their history:
+   the tile and its eight neighbours are all periodic (or long empty), so the
+   whole neighbourhood equals what it was `lag` generations ago, where lag
+   is the lcm of their periods, and so will the tile's next generation. */
+static void tile_phase_map_plan(struct tile_phase_map *map, const struct life_rule *rule, size_t generation) {
+    map->skipped = 0;
+    map->active_cells = 0;
+    map->paused = generation < map->resume;
+    if (map->paused) {
+        return;
+    }
+    if (map->generation != generation || !life_rule_equal(&map->rule, rule)) {
+        tile_phase_map_reset(map);
+        map->rule = *rule;
+        map->generation = generation;
+    }
+    bool trusted = map->recorded >= PHASE_HISTORY;
+    size_t slot = generation % PHASE_HISTORY;
+    for (size_t i = 0; i < map->capacity; ++i) {
+        for (struct tile_phase *phase = map->buckets[i]; phase; phase = phase->next) {
+            phase->skip = false;
+            if (!trusted || phase->period == 0 || phase->empty_run > 0) {
+                continue;
+            }
+            int lag = phase->period;
+            bool settled = true;
+            for (int n = 0; n < 9 && settled; ++n) {
+                const struct tile_phase *other = tile_phase_find(map, phase->tx + n % 3 - 1, phase->ty + n / 3 - 1);
+                if (other && other != phase) {
+                    settled = other->period != 0;
+                    lag = settled ? lag / gcd_int(lag, other->period) * other->period : lag;
+                }
+            }
+            phase->skip = settled;
+            phase->lag = lag;
+            map->skipped += settled ? 1 : 0;
+        }
+    }
+    if (trusted && map->skipped * 8 < map->size) {
+        tile_phase_map_reset(map);
+        map->resume = generation + PHASE_BACKOFF;
+        map->paused = true;
+        return;
+    }
+    /* Live cells the stepper still has to visit: everything outside the
+       skipped tiles plus their border rings. */
+    const uint32_t ring = 1u | (1u << (TILE_SIZE - 1));
+    for (size_t i = 0; map->skipped > 0 && i < map->capacity; ++i) {
+        for (const struct tile_phase *phase = map->buckets[i]; phase; phase = phase->next) {
+            for (int r = 0; r < TILE_SIZE; ++r) {
+                uint32_t bits = phase->rows[slot][r];
+                bool edge = r == 0 || r == TILE_SIZE - 1 || !phase->skip;
+                map->active_cells += (size_t)__builtin_popcount(edge ? bits : bits & ring);
+            }
+        }
+    }
+}
+
+static bool tile_phase_skipped(const struct tile_phase_map *map, int x, int y, bool interior_only) {
+    int tx = tile_coord(x);
+    int ty = tile_coord(y);
+    const struct tile_phase *phase = tile_phase_find(map, tx, ty);
+    if (!phase || !phase->skip) {
+        return false;
+    }
+    if (!interior_only) {
+        return true;
+    }
+    int lx = x - tx * TILE_SIZE;
+    int ly = y - ty * TILE_SIZE;
+    return lx > 0 && lx < TILE_SIZE - 1 && ly > 0 && ly < TILE_SIZE - 1;
+}
+
+static bool tile_phase_repeats(const struct tile_phase *phase, size_t generation, int period) {
+    for (int back = 0; back + period < PHASE_HISTORY; ++back) {
+        size_t s = (generation - (size_t)back) % PHASE_HISTORY;
+        size_t t = (generation - (size_t)back - (size_t)period) % PHASE_HISTORY;
+        if (phase->hashes[s] != phase->hashes[t] || memcmp(phase->rows[s], phase->rows[t], sizeof(phase->rows[s])) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Records generation `generation` (already in `live`) for every tile. */
+static void tile_phase_map_record(struct tile_phase_map *map, const struct cell_set *live, size_t generation) {
+    if (map->paused) {
+        return;
+    }
+    size_t slot = generation % PHASE_HISTORY;
+    for (size_t i = 0; i < map->capacity; ++i) {
+        for (struct tile_phase *phase = map->buckets[i]; phase; phase = phase->next) {
+            if (!phase->skip) {
+                memset(phase->rows[slot], 0, sizeof(phase->rows[slot]));
+            }
+        }
+    }
+    struct cell_iterator it = cell_set_iter(live);
+    int x, y;
+    while (cell_iter_next(&it, &x, &y)) {
+        int tx = tile_coord(x);
+        int ty = tile_coord(y);
+        struct tile_phase *phase = tile_phase_get(map, tx, ty);
+        if (!phase->skip) {
+            phase->rows[slot][y - ty * TILE_SIZE] |= 1u << (x - tx * TILE_SIZE);
+        }
+    }
+
+    map->recorded++;
+    map->generation = generation;
+    for (size_t i = 0; i < map->capacity; ++i) {
+        struct tile_phase **link = &map->buckets[i];
+        while (*link) {
+            struct tile_phase *phase = *link;
+            phase->hashes[slot] = tile_content_hash(phase->rows[slot]);
+            uint32_t any = 0;
+            for (int r = 0; r < TILE_SIZE; ++r) {
+                any |= phase->rows[slot][r];
+            }
+            phase->empty_run = any ? 0 : phase->empty_run + 1;
+            if (phase->empty_run >= PHASE_HISTORY) {
+                *link = phase->next;
+                free(phase);
+                map->size--;
+                continue;
+            }
+            phase->period = 0;
+            for (int p = 1; p <= 4 && map->recorded >= PHASE_HISTORY && phase->period == 0; ++p) {
+                phase->period = tile_phase_repeats(phase, generation, p) ? p : 0;
+            }
+            link = &phase->next;
+        }
+    }
+}
+
+#define LATENCY_BUCKETS 160
+
+/* Log-linear histogram: four sub-buckets per power of two of nanoseconds,
+   so every bucket is within 25% of its neighbours. */
+struct latency_histogram {
+    uint64_t counts[LATENCY_BUCKETS];
+    uint64_t total;
+    double sum_seconds;
+    double max_seconds;
+};
+
+enum spaceship_kind { SHIP_GLIDER, SHIP_LWSS, SHIP_MWSS, SHIP_HWSS, SHIP_KINDS };
+
+static const char *const SHIP_NAMES[SHIP_KINDS] = {"glider", "lwss", "mwss", "hwss"};
+
+struct run_stats {
+    struct latency_histogram step_latency;
+    struct latency_histogram render_latency;
+    uint64_t generations;
+    double step_seconds;
+    /* Spaceships removed by --remove-escapees, by kind. */
+    uint64_t escapees[SHIP_KINDS];
+    /* Tiles tracked and tiles copied from their phase history by the
+       one-generation stepper. */
+    uint64_t tracked_tile_steps;
+    uint64_t periodic_tile_steps;
+};
+
+static int latency_bucket(double seconds) {
+    uint64_t ns = seconds > 0.0 ? (uint64_t)(seconds * 1e9) : 0;
+    if (ns < 4) {
+        return (int)ns;
+    }
+    int msb = 63 - __builtin_clzll(ns);
+    int bucket = (msb - 1) * 4 + (int)((ns >> (msb - 2)) & 3);
+    return MIN(bucket, LATENCY_BUCKETS - 1);
+}
+
+static double latency_bucket_upper(int bucket) {
+    if (bucket < 4) {
+        return (double)(bucket + 1) / 1e9;
+    }
+    int msb = bucket / 4 + 1;
+    uint64_t lower = (uint64_t)(4 + bucket % 4) << (msb - 2);
+    return (double)(lower + ((uint64_t)1 << (msb - 2))) / 1e9;
+}
+
+static void latency_histogram_record(struct latency_histogram *hist, double seconds) {
+    hist->counts[latency_bucket(seconds)]++;
+    hist->total++;
+    hist->sum_seconds += seconds;
+    hist->max_seconds = MAX(hist->max_seconds, seconds);
+}
+
+static double latency_histogram_percentile(const struct latency_histogram *hist, double quantile) {
+    if (hist->total == 0) {
+        return 0.0;
+    }
+    uint64_t rank = (uint64_t)(quantile * (double)hist->total);
+    if (rank >= hist->total) {
+        rank = hist->total - 1;
+    }
+    uint64_t seen = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; ++b) {
+        seen += hist->counts[b];
+        if (seen > rank) {
+            return MIN(latency_bucket_upper(b), hist->max_seconds);
+        }
+    }
+    return hist->max_seconds;
+}
+
+struct publisher;
+struct control_server;
+
+struct life_state {
+    struct cell_set live;
+    size_t generation;
+    struct life_census census;
+    struct life_rule rule;
+    struct tile_store tile_store;
+    struct tile_phase_map phases;
+    struct cold_store cold;
+    struct scheduler *scheduler;
+    struct publisher *publisher;
+    struct control_server *control;
+    struct run_stats stats;
+    const char *metrics_path;
+    double metrics_written;
+    bool remove_escapees;
+};
+
+static void life_state_init(struct life_state *state) {
+    cell_set_init(&state->live, INITIAL_HASH_CAPACITY);
+    state->generation = 0;
+    life_census_reset(&state->census);
+    state->rule = CONWAY_RULE;
+    tile_store_init(&state->tile_store);
+    tile_phase_map_init(&state->phases);
+    cold_store_init(&state->cold);
+    state->scheduler = NULL;
+    state->publisher = NULL;
+    state->control = NULL;
+    memset(&state->stats, 0, sizeof(state->stats));
+    state->metrics_path = NULL;
+    state->metrics_written = 0.0;
+    state->remove_escapees = false;
+}
+
+static void life_state_clear(struct life_state *state) {
+    cell_set_clear(&state->live);
+    state->generation = 0;
+    life_census_reset(&state->census);
+    tile_phase_map_reset(&state->phases);
+    cold_store_reset(&state->cold);
+}
+
+static void life_state_recount(struct life_state *state) {
+    tile_phase_map_reset(&state->phases);
+    life_census_reset(&state->census);
+    struct cell_iterator it = cell_set_iter(&state->live);
+    int x, y;
+    while (cell_iter_next(&it, &x, &y)) {
+        life_census_add(&state->census, x, y);
+    }
+    for (size_t i = 0; i < state->cold.index_capacity; ++i) {
+        if (state->cold.index[i].used) {
+            life_census_add_block(&state->census, &state->cold.index[i], state->generation);
+        }
+    }
+}
+
+static void life_state_destroy(struct life_state *state) {
+    cell_set_destroy(&state->live);
+    tile_store_destroy(&state->tile_store);
+    tile_phase_map_destroy(&state->phases);
+    cold_store_destroy(&state->cold);
+}
+
+static void life_state_apply_batch(const struct life_state *state, struct cell_set *next, struct life_census *census,
+                                   const uint64_t *keys, const int *neighbours, size_t count) {
+    bool alive[LOOKUP_BATCH];
+    cell_set_contains_batch(&state->live, keys, count, alive);
+    for (size_t i = 0; i < count; ++i) {
+        uint16_t mask = (uint16_t)(1u << neighbours[i]);
+        if ((alive[i] ? state->rule.survive : state->rule.birth) & mask) {
+            int x = cell_key_x(keys[i]);
+            int y = cell_key_y(keys[i]);
+            cell_set_insert(next, x, y);
+            life_census_add_cell(census, x, y, !alive[i]);
+        }
+    }
+}
+
+static void life_state_step_n(struct life_state *state, size_t n);
+
+static void life_state_step(struct life_state *state) {
+    if (life_rule_is_ltl(&state->rule)) {
+        life_state_step_n(state, 1);
+        return;
+    }
+    /* This stepper keeps no change history, so cold tiles come back first. */
+    cold_store_thaw(&state->cold, &state->live, state->generation);
+    struct tile_phase_map *phases = &state->phases;
+    tile_phase_map_plan(phases, &state->rule, state->generation);
+    bool skipping = phases->skipped > 0;
+
+    struct count_map counts;
+    size_t active = skipping ? phases->active_cells : cell_set_count(&state->live);
+    count_map_init(&counts, MAX((size_t)COUNT_HASH_CAPACITY, active * 8));
+
+    uint64_t keys[LOOKUP_BATCH];
+    size_t pending = 0;
+    enum neighbourhood shape = state->rule.neighbourhood;
+    struct cell_iterator it = cell_set_iter(&state->live);
+    int x, y;
+    while (cell_iter_next(&it, &x, &y)) {
+        /* Skipped tiles still feed their border cells to the neighbours. */
+        if (skipping && tile_phase_skipped(phases, x, y, true)) {
+            continue;
+        }
+        if (pending + 8 > LOOKUP_BATCH) {
+            count_map_increment_batch(&counts, keys, pending);
+            pending = 0;
+        }
+        keys[pending++] = cell_key(x - 1, y);
+        keys[pending++] = cell_key(x + 1, y);
+        keys[pending++] = cell_key(x, y - 1);
+        keys[pending++] = cell_key(x, y + 1);
+        if (shape != NEIGHBOURHOOD_VON_NEUMANN) {
+            keys[pending++] = cell_key(x - 1, y - 1);
+            keys[pending++] = cell_key(x + 1, y + 1);
+        }
+        if (shape == NEIGHBOURHOOD_MOORE) {
+            keys[pending++] = cell_key(x + 1, y - 1);
+            keys[pending++] = cell_key(x - 1, y + 1);
+        }
+        if (state->rule.survive & 1u) {
+            count_map_get(&counts, x, y);
+        }
+    }
+    count_map_increment_batch(&counts, keys, pending);
+    pending = 0;
+
+    struct cell_set next;
+    cell_set_init(&next, state->live.capacity);
+
+    uint64_t updated = 0;
+    struct life_census census;
+    life_census_reset(&census);
+    int neighbours[LOOKUP_BATCH];
+    for (size_t i = 0; i < counts.capacity; ++i) {
+        if (!counts.slots[i].used) {
+            continue;
+        }
+        uint64_t key = counts.slots[i].key;
+        if (skipping && tile_phase_skipped(phases, cell_key_x(key), cell_key_y(key), false)) {
+            continue;
+        }
+        keys[pending] = key;
+        neighbours[pending++] = counts.slots[i].count;
+        if (pending == LOOKUP_BATCH) {
+            life_state_apply_batch(state, &next, &census, keys, neighbours, pending);
+            updated += pending;
+            pending = 0;
+        }
+    }
+    life_state_apply_batch(state, &next, &census, keys, neighbours, pending);
+    updated += pending;
+
+    size_t slot = (state->generation + 1) % PHASE_HISTORY;
+    for (size_t i = 0; skipping && i < phases->capacity; ++i) {
+        for (struct tile_phase *phase = phases->buckets[i]; phase; phase = phase->next) {
+            if (!phase->skip) {
+                continue;
+            }
+            size_t source = (state->generation + 1 - (size_t)phase->lag) % PHASE_HISTORY;
+            memmove(phase->rows[slot], phase->rows[source], sizeof(phase->rows[slot]));
+            for (int r = 0; r < TILE_SIZE; ++r) {
+                uint32_t bits = phase->rows[slot][r];
+                while (bits) {
+                    int c = __builtin_ctz(bits);
+                    bits &= bits - 1;
+                    int cx = phase->tx * TILE_SIZE + c;
+                    int cy = phase->ty * TILE_SIZE + r;
+                    cell_set_insert(&next, cx, cy);
+                    life_census_add_next(&census, &state->live, cx, cy);
+                }
+            }
+        }
+    }
+
+    cell_set_destroy(&state->live);
+    life_census_finish(&census, &state->census);
+    state->census = census;
+    state->live = next;
+    state->generation += 1;
+    counter_add(&counters.cells_updated, updated);
+    tile_phase_map_record(phases, &state->live, state->generation);
+    state->stats.periodic_tile_steps += phases->skipped;
+    state->stats.tracked_tile_steps += phases->size;
+
+    count_map_destroy(&counts);
+}
+
+struct tile_export_job {
+    const struct tile *tile;
+    struct concurrent_cell_set *set;
+};
+
+static size_t tile_population(const struct tile *tile) {
+    size_t count = 0;
+    for (int r = 0; r < TILE_SIZE; ++r) {
+        count += (size_t)__builtin_popcount(tile->content->rows[r]);
+    }
+    return count;
+}
+
+static void tile_export_job_run(void *arg) {
+    struct tile_export_job *job = arg;
+    const struct tile *tile = job->tile;
+    for (int r = 0; r < TILE_SIZE; ++r) {
+        uint32_t bits = tile->content->rows[r];
+        while (bits) {
+            int c = __builtin_ctz(bits);
+            bits &= bits - 1;
+            concurrent_cell_set_insert(job->set, tile->tx * TILE_SIZE + c, tile->ty * TILE_SIZE + r);
+        }
+    }
+}
+
+static void tile_map_export(const struct tile_map *tiles, const struct cell_set *previous, struct cell_set *live,
+                            struct life_census *census, struct scheduler *sched) {
+    size_t population = 0;
+    for (size_t i = 0; i < tiles->capacity; ++i) {
+        for (const struct tile *tile = tiles->buckets[i]; tile; tile = tile->next) {
+            population += tile_population(tile);
+        }
+    }
+    cell_set_init(live, next_power_of_two(MAX(population * 2, (size_t)INITIAL_HASH_CAPACITY)));
+    life_census_reset(census);
+
+    if (!sched || sched->worker_count < 2) {
+        for (size_t i = 0; i < tiles->capacity; ++i) {
+            for (const struct tile *tile = tiles->buckets[i]; tile; tile = tile->next) {
+                for (int r = 0; r < TILE_SIZE; ++r) {
+                    uint32_t bits = tile->content->rows[r];
+                    while (bits) {
+                        int c = __builtin_ctz(bits);
+                        bits &= bits - 1;
+                        int x = tile->tx * TILE_SIZE + c;
+                        int y = tile->ty * TILE_SIZE + r;
+                        cell_set_insert(live, x, y);
+                        life_census_add_next(census, previous, x, y);
+                    }
+                }
+            }
+        }
+        return;
+    }
+
+    struct concurrent_cell_set births;
+    concurrent_cell_set_init(&births, population);
+    struct tile_export_job *jobs = malloc(MAX(tiles->size, (size_t)1) * sizeof(struct tile_export_job));
+    if (!jobs) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    struct task_group group;
+    atomic_init(&group.pending, 0);
+    size_t count = 0;
+    for (size_t i = 0; i < tiles->capacity; ++i) {
+        for (const struct tile *tile = tiles->buckets[i]; tile; tile = tile->next) {
+            jobs[count].tile = tile;
+            jobs[count].set = &births;
+            int worker = (int)(count * (size_t)sched->worker_count / tiles->size);
+            scheduler_spawn_on(sched, worker, &group, tile_export_job_run, &jobs[count]);
+            count++;
+        }
+    }
+    scheduler_wait(sched, &group);
+    concurrent_cell_set_drain(&births, live, previous, census);
+    free(jobs);
+    concurrent_cell_set_destroy(&births);
+}
+
+static void life_state_step_n(struct life_state *state, size_t n) {
+    if (n == 0) {
+        return;
+    }
+
+    /* One latency sample per block; the first and last also carry the
+       import into tiles and the export back to cells. */
+    double block_start = monotonic_seconds();
+    struct tile_store *store = &state->tile_store;
+    tile_store_prepare(store, &state->rule);
+    struct tile_map tiles;
+    tile_map_init(&tiles, TILE_HASH_CAPACITY);
+    struct cell_iterator it = cell_set_iter(&state->live);
+    int x, y;
+    while (cell_iter_next(&it, &x, &y)) {
+        int tx = tile_coord(x);
+        int ty = tile_coord(y);
+        struct tile *tile = tile_map_get(&tiles, tx, ty);
+        if (!tile->content) {
+            tile->content = calloc(1, sizeof(*tile->content));
+            if (!tile->content) {
+                perror("calloc");
+                exit(EXIT_FAILURE);
+            }
+        }
+        tile->content->rows[y - ty * TILE_SIZE] |= 1u << (x - tx * TILE_SIZE);
+    }
+    /* The tiles were filled in private buffers; swap those for shared copies. */
+    for (size_t i = 0; i < tiles.capacity; ++i) {
+        for (struct tile *tile = tiles.buckets[i]; tile; tile = tile->next) {
+            struct tile_content *scratch = tile->content;
+            tile->content = tile_store_intern(store, scratch->rows);
+            free(scratch);
+        }
+    }
+    struct cold_store *cold = &state->cold;
+    bool tracking = cold_store_enabled(cold);
+    if (tracking) {
+        cold_store_begin(cold, state->generation, &state->rule, store, &tiles);
+    }
+
+    /* Each block advances every tile up to TILE_HALO generations inside a
+       window that carries TILE_HALO cells of neighbour context, so tiles only
+       exchange halos once per block instead of once per generation. */
+    while (n > 0) {
+        /* Larger than Life neighbourhoods reach up to a full halo in one
+           generation, so those rules advance one generation per block. */
+        int gens = life_rule_is_ltl(&state->rule) ? 1 : (int)MIN(n, (size_t)TILE_HALO);
+        struct tile_map next;
+        tile_map_init(&next, MAX(tiles.capacity, (size_t)TILE_HASH_CAPACITY));
+        struct tile_changes changes;
+        if (tracking) {
+            /* Period-2 tiles only repeat after an even number of generations,
+               so blocks stay even where they can, and an odd one first brings
+               back the cold tiles that oscillating tiles will read. */
+            if (gens > 1 && gens % 2 != 0) {
+                gens--;
+            }
+            if (cold->history && gens % 2 != 0) {
+                cold_store_fault_near(cold, &cold->changes.changed, state->generation, store, &tiles, NULL);
+            }
+            tile_changes_init(&changes, MAX(cell_set_count(&cold->changes.changed) * 2, (size_t)INITIAL_HASH_CAPACITY));
+        }
+        tile_map_step_block(store, &tiles, &next, gens, &state->rule, state->scheduler,
+                            tracking && cold->history ? &cold->changes : NULL, tracking ? &changes : NULL);
+        tile_map_destroy(&tiles);
+        tiles = next;
+        state->generation += (size_t)gens;
+        n -= (size_t)gens;
+        if (tracking) {
+            tile_changes_destroy(&cold->changes);
+            cold->changes = changes;
+            cold->history = true;
+            cold->generation = state->generation;
+            cold->rule = state->rule;
+            cold_store_settle(cold, state->generation, &state->rule, store, &tiles);
+        }
+        if (tile_store_live_bytes(store) > store->budget) {
+            tile_store_collect(store, &tiles);
+        }
+        if (n > 0) {
+            double now = monotonic_seconds();
+            latency_histogram_record(&state->stats.step_latency, now - block_start);
+            block_start = now;
+        }
+    }
+
+    struct cell_set next;
+    struct life_census census;
+    tile_map_export(&tiles, &state->live, &next, &census, state->scheduler);
+    if (tracking) {
+        cold_store_census(cold, &census, &state->live, &tiles, state->generation);
+    }
+    life_census_finish(&census, &state->census);
+    cell_set_destroy(&state->live);
+    state->live = next;
+    state->census = census;
+    tile_map_destroy(&tiles);
+    latency_histogram_record(&state->stats.step_latency, monotonic_seconds() - block_start);
+}
+
+static int life_state_import_file(struct life_state *state, const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        return -1;
+    }
+    life_state_clear(state);
+    char *line = NULL;
+    size_t len = 0;
+    ssize_t read;
+    int y = 0;
+    while ((read = getline(&line, &len, fp)) != -1) {
+        if (read > 0 && (line[0] == '!' || line[0] == '#')) {
+            continue;
+        }
+        for (int x = 0; x < read; ++x) {
+            char c = line[x];
+            if (c == '\n' || c == '\r') {
+                break;
+            }
+            if (c == 'O' || c == 'o' || c == 'X' || c == '1') {
+                if (!cell_set_contains(&state->live, x, y)) {
+                    life_census_add(&state->census, x, y);
+                }
+                cell_set_insert(&state->live, x, y);
+            }
+        }
+        y += 1;
+    }
+    free(line);
+    fclose(fp);
+    return 0;
+}
+
+#define PUBLISH_MAGIC 0x474f4c53u
+#define PUBLISH_VERSION 1u
+#define PUBLISH_MAX_CELLS ((size_t)4 << 20)
+
+/* Layout of the shared-memory segment. Readers copy everything between two
+   loads of `sequence` and retry if it was odd or changed (a seqlock), so the
+   stepper never waits for them. When the population exceeds the segment's
+   capacity only the summary fields are published and `cell_count` is 0. */
+/* Writes the (x, y) pairs of every live cell to `cells`, which must have
+   room for the census population. Cold tiles are read in their current
+   phase without being faulted back in. Returns the number of cells. */
+static size_t life_state_copy_cells(const struct life_state *life, int32_t *cells) {
+    size_t n = 0;
+    struct cell_iterator it = cell_set_iter(&life->live);
+    int x, y;
+    while (cell_iter_next(&it, &x, &y)) {
+        cells[2 * n] = x;
+        cells[2 * n + 1] = y;
+        n++;
+    }
+    const struct cold_store *cold = &life->cold;
+    for (size_t i = 0; i < cold->index_capacity; ++i) {
+        const struct cold_entry *entry = &cold->index[i];
+        if (!entry->used) {
+            continue;
+        }
+        uint32_t rows[TILE_SIZE];
+        cold_store_read(cold, entry, life->generation, rows);
+        for (int r = 0; r < TILE_SIZE; ++r) {
+            for (uint32_t bits = rows[r]; bits; bits &= bits - 1) {
+                cells[2 * n] = cell_key_x(entry->key) * TILE_SIZE + __builtin_ctz(bits);
+                cells[2 * n + 1] = cell_key_y(entry->key) * TILE_SIZE + r;
+                n++;
+            }
+        }
+    }
+    return n;
+}
+
+struct published_state {
+    uint32_t magic;
+    uint32_t version;
+    _Atomic uint64_t sequence;
+    uint64_t generation;
+    uint64_t population;
+    int32_t min_x;
+    int32_t min_y;
+    int32_t max_x;
+    int32_t max_y;
+    uint64_t cell_capacity;
+    uint64_t cell_count;
+    int32_t cells[];
+};
+
+struct publisher {
+    char name[256];
+    struct published_state *shared;
+    size_t size;
+};
+
+static size_t published_state_size(size_t capacity) {
+    return sizeof(struct published_state) + capacity * 2 * sizeof(int32_t);
+}
+
+static struct publisher *publisher_create(const char *name) {
+    struct publisher *pub = calloc(1, sizeof(*pub));
+    if (!pub) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    snprintf(pub->name, sizeof(pub->name), "%s%s", name[0] == '/' ? "" : "/", name);
+    pub->size = published_state_size(PUBLISH_MAX_CELLS);
+
+    /* Never take over a segment that another publisher or an observer may
+       still have mapped. */
+    int fd = shm_open(pub->name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd == -1 && errno == EEXIST) {
+        fprintf(stderr, "shm_open %s: segment already exists; is another process publishing it? (remove /dev/shm%s if not)\n",
+                pub->name, pub->name);
+        free(pub);
+        return NULL;
+    }
+    if (fd == -1) {
+        fprintf(stderr, "shm_open %s: %s\n", pub->name, strerror(errno));
+        free(pub);
+        return NULL;
+    }
+    if (ftruncate(fd, (off_t)pub->size) == -1) {
+        perror("ftruncate");
+        close(fd);
+        shm_unlink(pub->name);
+        free(pub);
+        return NULL;
+    }
+    pub->shared = mmap(NULL, pub->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (pub->shared == MAP_FAILED) {
+        perror("mmap");
+        shm_unlink(pub->name);
+        free(pub);
+        return NULL;
+    }
+    pub->shared->magic = PUBLISH_MAGIC;
+    pub->shared->version = PUBLISH_VERSION;
+    pub->shared->cell_capacity = PUBLISH_MAX_CELLS;
+    atomic_store(&pub->shared->sequence, 0);
+    return pub;
+}
+
+static void publisher_destroy(struct publisher *pub) {
+    if (!pub) {
+        return;
+    }
+    munmap(pub->shared, pub->size);
+    shm_unlink(pub->name);
+    free(pub);
+}
+
+static void publisher_publish(struct publisher *pub, const struct life_state *life) {
+    if (!pub) {
+        return;
+    }
+    struct published_state *shared = pub->shared;
+    uint64_t sequence = atomic_load_explicit(&shared->sequence, memory_order_relaxed);
+    atomic_store_explicit(&shared->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    const struct life_census *census = &life->census;
+    size_t population = census->population;
+    bool with_cells = population <= shared->cell_capacity;
+    if (with_cells) {
+        life_state_copy_cells(life, shared->cells);
+    }
+    shared->generation = life->generation;
+    shared->population = population;
+    shared->min_x = population ? census->min_x : 0;
+    shared->min_y = population ? census->min_y : 0;
+    shared->max_x = population ? census->max_x : -1;
+    shared->max_y = population ? census->max_y : -1;
+    shared->cell_count = with_cells ? population : 0;
+
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&shared->sequence, sequence + 2, memory_order_relaxed);
+}
+
+static int run_observer(const char *name) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s%s", name[0] == '/' ? "" : "/", name);
+    int fd = shm_open(path, O_RDONLY, 0);
+    if (fd == -1) {
+        fprintf(stderr, "shm_open %s: %s\n", path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(struct published_state)) {
+        fprintf(stderr, "%s is not a published state segment\n", path);
+        close(fd);
+        return EXIT_FAILURE;
+    }
+    size_t size = (size_t)st.st_size;
+    const struct published_state *shared = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (shared == MAP_FAILED) {
+        perror("mmap");
+        return EXIT_FAILURE;
+    }
+    if (shared->magic != PUBLISH_MAGIC || shared->version != PUBLISH_VERSION) {
+        fprintf(stderr, "%s has an unknown layout\n", path);
+        munmap((void *)shared, size);
+        return EXIT_FAILURE;
+    }
+
+    /* The cell list is copied inside the retry loop as well, so a torn read
+       of it is retried like one of the summary fields. */
+    struct published_state *state = (struct published_state *)shared;
+    size_t room = (size - sizeof(struct published_state)) / (2 * sizeof(int32_t));
+    uint64_t generation, population, cell_count;
+    int32_t min_x, min_y, max_x, max_y;
+    int32_t *cells = NULL;
+    size_t cells_capacity = 0;
+    for (;;) {
+        uint64_t before = atomic_load_explicit(&state->sequence, memory_order_acquire);
+        if (before & 1) {
+            sched_yield();
+            continue;
+        }
+        generation = state->generation;
+        population = state->population;
+        cell_count = state->cell_count;
+        min_x = state->min_x;
+        min_y = state->min_y;
+        max_x = state->max_x;
+        max_y = state->max_y;
+        size_t copied = (size_t)MIN(cell_count, (uint64_t)MIN(room, (size_t)state->cell_capacity));
+        if (copied > cells_capacity) {
+            int32_t *grown = realloc(cells, copied * 2 * sizeof(int32_t));
+            if (!grown) {
+                perror("realloc");
+                exit(EXIT_FAILURE);
+            }
+            cells = grown;
+            cells_capacity = copied;
+        }
+        if (copied > 0) {
+            memcpy(cells, state->cells, copied * 2 * sizeof(int32_t));
+        }
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&state->sequence, memory_order_relaxed) == before) {
+            break;
+        }
+    }
+
+    /* A consistent copy lists every live cell, all inside the bounding box,
+       or none when the population did not fit. */
+    int status = EXIT_SUCCESS;
+    size_t outside = 0;
+    if (cell_count != 0 && (cell_count != population || cell_count > room)) {
+        fprintf(stderr, "%s: header lists %llu cells for a population of %llu\n", path, (unsigned long long)cell_count,
+                (unsigned long long)population);
+        status = EXIT_FAILURE;
+    } else {
+        for (size_t i = 0; i < cell_count; ++i) {
+            int32_t x = cells[2 * i];
+            int32_t y = cells[2 * i + 1];
+            outside += x < min_x || x > max_x || y < min_y || y > max_y ? 1 : 0;
+        }
+        if (outside > 0) {
+            fprintf(stderr, "%s: %zu published cells lie outside the bounding box\n", path, outside);
+            status = EXIT_FAILURE;
+        }
+    }
+    printf("Generation: %llu | Live cells: %llu | Bounding box: (%d,%d)-(%d,%d) | Cells published: %llu\n",
+           (unsigned long long)generation, (unsigned long long)population, min_x, min_y, max_x, max_y,
+           (unsigned long long)cell_count);
+    free(cells);
+    munmap((void *)shared, size);
+    return status;
+}
+
+/* Escaping spaceships are found by grouping live cells that lie within two
+   cells of each other (every phase of the standard ships forms one group),
+   matching small groups against every phase and orientation of the glider
+   and the light, middle and heavy-weight spaceships, and keeping only those
+   already clear of the bounding box of everything else on a side they are
+   moving away from. */
+struct spaceship_phase {
+    int kind;
+    int width;
+    int height;
+    int count;
+    int dx;
+    int dy;
+    uint64_t keys[ESCAPE_MAX_CELLS];
+};
+
+static struct spaceship_phase spaceship_phases[SHIP_KINDS * 8 * 4];
+static int spaceship_phase_count = 0;
+
+static int compare_keys(const void *a, const void *b) {
+    uint64_t ka = *(const uint64_t *)a;
+    uint64_t kb = *(const uint64_t *)b;
+    return ka < kb ? -1 : ka > kb;
+}
+
+/* Translates cells so the bounding box starts at the origin and sorts them,
+   giving a canonical form that two copies of the same shape share. */
+static void spaceship_normalize(const int *xs, const int *ys, int count, uint64_t *keys, int *width, int *height) {
+    int min_x = xs[0], min_y = ys[0], max_x = xs[0], max_y = ys[0];
+    for (int i = 1; i < count; ++i) {
+        min_x = MIN(min_x, xs[i]);
+        max_x = MAX(max_x, xs[i]);
+        min_y = MIN(min_y, ys[i]);
+        max_y = MAX(max_y, ys[i]);
+    }
+    for (int i = 0; i < count; ++i) {
+        keys[i] = cell_key(xs[i] - min_x, ys[i] - min_y);
+    }
+    qsort(keys, (size_t)count, sizeof(*keys), compare_keys);
+    *width = max_x - min_x + 1;
+    *height = max_y - min_y + 1;
+}
+
+static void spaceship_table_init(void) {
+    static const char *const patterns[SHIP_KINDS][5] = {
+        {".O.", "..O", "OOO", NULL},
+        {".O..O", "O....", "O...O", "OOOO.", NULL},
+        {"...O..", ".O...O", "O.....", "O....O", "OOOOO."},
+        {"...OO..", ".O....O", "O......", "O.....O", "OOOOOO."},
+    };
+    static const int velocity[SHIP_KINDS][2] = {{1, 1}, {-2, 0}, {-2, 0}, {-2, 0}};
+    static const int symmetries[8][4] = {
+        {1, 0, 0, 1}, {0, -1, 1, 0}, {-1, 0, 0, -1}, {0, 1, -1, 0},
+        {-1, 0, 0, 1}, {1, 0, 0, -1}, {0, 1, 1, 0}, {0, -1, -1, 0},
+    };
+    enum { GRID = 20, OFFSET = 8 };
+    for (int kind = 0; kind < SHIP_KINDS; ++kind) {
+        for (int s = 0; s < 8; ++s) {
+            const int *m = symmetries[s];
+            bool grid[GRID][GRID] = {{false}};
+            for (int row = 0; row < 5 && patterns[kind][row]; ++row) {
+                for (int col = 0; patterns[kind][row][col]; ++col) {
+                    if (patterns[kind][row][col] == 'O') {
+                        grid[OFFSET + m[2] * col + m[3] * row][OFFSET + m[0] * col + m[1] * row] = true;
+                    }
+                }
+            }
+            for (int phase = 0; phase < 4; ++phase) {
+                struct spaceship_phase *entry = &spaceship_phases[spaceship_phase_count++];
+                int xs[ESCAPE_MAX_CELLS], ys[ESCAPE_MAX_CELLS];
+                int count = 0;
+                for (int y = 0; y < GRID; ++y) {
+                    for (int x = 0; x < GRID; ++x) {
+                        if (grid[y][x]) {
+                            xs[count] = x;
+                            ys[count] = y;
+                            count++;
+                        }
+                    }
+                }
+                entry->kind = kind;
+                entry->count = count;
+                entry->dx = m[0] * velocity[kind][0] + m[1] * velocity[kind][1];
+                entry->dy = m[2] * velocity[kind][0] + m[3] * velocity[kind][1];
+                spaceship_normalize(xs, ys, count, entry->keys, &entry->width, &entry->height);
+
+                bool next[GRID][GRID] = {{false}};
+                for (int y = 1; y < GRID - 1; ++y) {
+                    for (int x = 1; x < GRID - 1; ++x) {
+                        int n = grid[y - 1][x - 1] + grid[y - 1][x] + grid[y - 1][x + 1] + grid[y][x - 1] + grid[y][x + 1] +
+                                grid[y + 1][x - 1] + grid[y + 1][x] + grid[y + 1][x + 1];
+                        next[y][x] = n == 3 || (n == 2 && grid[y][x]);
+                    }
+                }
+                memcpy(grid, next, sizeof(grid));
+            }
+        }
+    }
+}
+
+static int spaceship_match(const int *xs, const int *ys, int count, int *dx, int *dy) {
+    uint64_t keys[ESCAPE_MAX_CELLS];
+    int width, height;
+    spaceship_normalize(xs, ys, count, keys, &width, &height);
+    for (int i = 0; i < spaceship_phase_count; ++i) {
+        const struct spaceship_phase *entry = &spaceship_phases[i];
+        if (entry->count == count && entry->width == width && entry->height == height &&
+            memcmp(entry->keys, keys, (size_t)count * sizeof(*keys)) == 0) {
+            *dx = entry->dx;
+            *dy = entry->dy;
+            return entry->kind;
+        }
+    }
+    return -1;
+}
+
+struct escape_cluster {
+    int min_x;
+    int min_y;
+    int max_x;
+    int max_y;
+    int kind;
+    int dx;
+    int dy;
+    int count;
+    int xs[ESCAPE_MAX_CELLS];
+    int ys[ESCAPE_MAX_CELLS];
+};
+
+static bool escape_clear_of(const struct escape_cluster *ship, const struct escape_cluster *rest) {
+    return (ship->dx > 0 && ship->min_x > rest->max_x + ESCAPE_MARGIN) ||
+           (ship->dx < 0 && ship->max_x < rest->min_x - ESCAPE_MARGIN) ||
+           (ship->dy > 0 && ship->min_y > rest->max_y + ESCAPE_MARGIN) ||
+           (ship->dy < 0 && ship->max_y < rest->min_y - ESCAPE_MARGIN);
+}
+
+/* Removes isolated spaceships heading away from the rest of the pattern and
+   counts them by kind in the run statistics. Only meaningful for B3/S23. */
+static void life_state_remove_escapees(struct life_state *state) {
+    if (!life_rule_is_conway(&state->rule) || state->census.population == 0) {
+        return;
+    }
+    if (spaceship_phase_count == 0) {
+        spaceship_table_init();
+    }
+    struct cell_set visited;
+    cell_set_init(&visited, state->live.size * 2);
+    size_t stack_capacity = 64;
+    uint64_t *stack = malloc(stack_capacity * sizeof(*stack));
+    size_t cluster_capacity = 64, cluster_count = 0;
+    struct escape_cluster *clusters = malloc(cluster_capacity * sizeof(*clusters));
+    if (!stack || !clusters) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+
+    struct cell_iterator it = cell_set_iter(&state->live);
+    int x, y;
+    while (cell_iter_next(&it, &x, &y)) {
+        if (cell_set_contains(&visited, x, y)) {
+            continue;
+        }
+        if (cluster_count == cluster_capacity) {
+            cluster_capacity *= 2;
+            clusters = realloc(clusters, cluster_capacity * sizeof(*clusters));
+            if (!clusters) {
+                perror("realloc");
+                exit(EXIT_FAILURE);
+            }
+        }
+        struct escape_cluster *cluster = &clusters[cluster_count++];
+        cluster->min_x = cluster->max_x = x;
+        cluster->min_y = cluster->max_y = y;
+        cluster->count = 0;
+        cell_set_insert(&visited, x, y);
+        size_t depth = 0;
+        stack[depth++] = cell_key(x, y);
+        while (depth > 0) {
+            uint64_t key = stack[--depth];
+            int cx = cell_key_x(key), cy = cell_key_y(key);
+            if (cluster->count < ESCAPE_MAX_CELLS) {
+                cluster->xs[cluster->count] = cx;
+                cluster->ys[cluster->count] = cy;
+            }
+            cluster->count++;
+            cluster->min_x = MIN(cluster->min_x, cx);
+            cluster->max_x = MAX(cluster->max_x, cx);
+            cluster->min_y = MIN(cluster->min_y, cy);
+            cluster->max_y = MAX(cluster->max_y, cy);
+            for (int oy = -2; oy <= 2; ++oy) {
+                for (int ox = -2; ox <= 2; ++ox) {
+                    int nx = cx + ox, ny = cy + oy;
+                    if (!cell_set_contains(&state->live, nx, ny) || cell_set_contains(&visited, nx, ny)) {
+                        continue;
+                    }
+                    cell_set_insert(&visited, nx, ny);
+                    if (depth == stack_capacity) {
+                        stack_capacity *= 2;
+                        stack = realloc(stack, stack_capacity * sizeof(*stack));
+                        if (!stack) {
+                            perror("realloc");
+                            exit(EXIT_FAILURE);
+                        }
+                    }
+                    stack[depth++] = cell_key(nx, ny);
+                }
+            }
+        }
+        cluster->kind = cluster->count <= ESCAPE_MAX_CELLS
+                            ? spaceship_match(cluster->xs, cluster->ys, cluster->count, &cluster->dx, &cluster->dy)
+                            : -1;
+    }
+    free(stack);
+    cell_set_destroy(&visited);
+
+    /* Cold tiles hold no ships but still count as the rest of the pattern. */
+    struct cold_store *cold = &state->cold;
+    if (cold->size > 0) {
+        if (cluster_count == cluster_capacity) {
+            clusters = realloc(clusters, ++cluster_capacity * sizeof(*clusters));
+            if (!clusters) {
+                perror("realloc");
+                exit(EXIT_FAILURE);
+            }
+        }
+        struct life_census bounds;
+        life_census_reset(&bounds);
+        for (size_t i = 0; i < cold->index_capacity; ++i) {
+            if (cold->index[i].used) {
+                life_census_add_block(&bounds, &cold->index[i], state->generation);
+            }
+        }
+        struct escape_cluster *rest = &clusters[cluster_count++];
+        rest->min_x = bounds.min_x;
+        rest->min_y = bounds.min_y;
+        rest->max_x = bounds.max_x;
+        rest->max_y = bounds.max_y;
+        rest->kind = -1;
+    }
+
+    size_t removed = 0;
+    for (size_t i = 0; i < cluster_count; ++i) {
+        struct escape_cluster *ship = &clusters[i];
+        if (ship->kind < 0) {
+            continue;
+        }
+        /* Ships removed earlier in this pass no longer count as matter, and
+           ships flying in formation with this one never close the gap. */
+        bool have_rest = false;
+        struct escape_cluster rest;
+        for (size_t j = 0; j < cluster_count; ++j) {
+            const struct escape_cluster *other = &clusters[j];
+            if (j == i || other->kind == -2 || (other->kind >= 0 && other->dx == ship->dx && other->dy == ship->dy)) {
+                continue;
+            }
+            rest.min_x = have_rest ? MIN(rest.min_x, other->min_x) : other->min_x;
+            rest.max_x = have_rest ? MAX(rest.max_x, other->max_x) : other->max_x;
+            rest.min_y = have_rest ? MIN(rest.min_y, other->min_y) : other->min_y;
+            rest.max_y = have_rest ? MAX(rest.max_y, other->max_y) : other->max_y;
+            have_rest = true;
+        }
+        if (have_rest && !escape_clear_of(ship, &rest)) {
+            continue;
+        }
+        for (int c = 0; c < ship->count; ++c) {
+            cell_set_remove(&state->live, ship->xs[c], ship->ys[c]);
+            if (cold->history) {
+                cell_set_insert(&cold->changes.changed, tile_coord(ship->xs[c]), tile_coord(ship->ys[c]));
+                cell_set_insert(&cold->changes.unsettled, tile_coord(ship->xs[c]), tile_coord(ship->ys[c]));
+            }
+        }
+        state->stats.escapees[ship->kind]++;
+        ship->kind = -2;
+        removed++;
+    }
+    free(clusters);
+
+    if (removed > 0) {
+        /* Removal is not a death; keep the last step's change counts. */
+        struct life_census stepped = state->census;
+        life_state_recount(state);
+        state->census.births = stepped.births;
+        state->census.deaths = stepped.deaths;
+        state->census.change_sum_x = stepped.change_sum_x;
+        state->census.change_sum_y = stepped.change_sum_y;
+    }
+}
+
+static void life_state_advance(struct life_state *state, size_t n) {
+    double start = monotonic_seconds();
+    if (n == 1) {
+        life_state_step(state);
+    } else {
+        life_state_step_n(state, n);
+    }
+    double elapsed = monotonic_seconds() - start;
+    /* The multi-generation stepper samples each of its blocks itself. */
+    if (n == 1 && !life_rule_is_ltl(&state->rule)) {
+        latency_histogram_record(&state->stats.step_latency, elapsed);
+    }
+    state->stats.generations += n;
+    state->stats.step_seconds += elapsed;
+    if (state->remove_escapees &&
+        (state->generation - n) / ESCAPE_CHECK_INTERVAL != state->generation / ESCAPE_CHECK_INTERVAL) {
+        life_state_remove_escapees(state);
+    }
+    publisher_publish(state->publisher, state);
+}
+
+static size_t cell_set_memory_bytes(const struct cell_set *set) {
+    size_t dead_bytes = set->old_dead ? (set->old_capacity + 63) / 64 * sizeof(*set->old_dead) : 0;
+    return (set->capacity + set->old_capacity) * sizeof(*set->slots) + dead_bytes;
+}
+
+/* Sums the transparent (AnonHugePages) and hugetlbfs huge pages mapped by
+   the process, in bytes. */
+static size_t process_huge_page_bytes(void) {
+    FILE *fp = fopen("/proc/self/smaps_rollup", "r");
+    if (!fp) {
+        return 0;
+    }
+    char line[256];
+    size_t total_kb = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        unsigned long kb = 0;
+        if (sscanf(line, "AnonHugePages: %lu kB", &kb) == 1 || sscanf(line, "Private_Hugetlb: %lu kB", &kb) == 1 ||
+            sscanf(line, "Shared_Hugetlb: %lu kB", &kb) == 1) {
+            total_kb += kb;
+        }
+    }
+    fclose(fp);
+    return total_kb << 10;
+}
+
+/* Counts data-TLB read misses of the calling thread; -1 where perf events
+   are unavailable (no PMU, or perf_event_paranoid forbids it). */
+static int dtlb_counter_open(void) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static bool dtlb_counter_read(int fd, uint64_t *misses) {
+    return fd >= 0 && read(fd, misses, sizeof(*misses)) == (ssize_t)sizeof(*misses);
+}
+
+static size_t process_resident_bytes(void) {
+    FILE *fp = fopen("/proc/self/statm", "r");
+    if (!fp) {
+        return 0;
+    }
+    unsigned long size_pages = 0;
+    unsigned long resident_pages = 0;
+    if (fscanf(fp, "%lu %lu", &size_pages, &resident_pages) != 2) {
+        resident_pages = 0;
+    }
+    fclose(fp);
+    return (size_t)resident_pages * (size_t)sysconf(_SC_PAGESIZE);
+}
+
+/* Live cells copied between generations, so that writing them out never
+   holds up the stepping thread. */
+struct cell_snapshot {
+    size_t generation;
+    struct life_rule rule;
+    int32_t *cells;
+    size_t count;
+    char path[PATH_MAX];
+};
+
+static struct cell_snapshot *cell_snapshot_take(const struct life_state *life, const char *path) {
+    struct cell_snapshot *snap = calloc(1, sizeof(*snap));
+    size_t population = life->census.population;
+    int32_t *cells = malloc(MAX(population, (size_t)1) * 2 * sizeof(int32_t));
+    if (!snap || !cells) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    snap->generation = life->generation;
+    snap->rule = life->rule;
+    snap->cells = cells;
+    snap->count = life_state_copy_cells(life, cells);
+    snprintf(snap->path, sizeof(snap->path), "%s", path);
+    return snap;
+}
+
+static void cell_snapshot_free(struct cell_snapshot *snap) {
+    if (snap) {
+        free(snap->cells);
+        free(snap);
+    }
+}
+
+static int compare_cell_rows(const void *a, const void *b) {
+    const int32_t *pa = a;
+    const int32_t *pb = b;
+    if (pa[1] != pb[1]) {
+        return pa[1] < pb[1] ? -1 : 1;
+    }
+    return pa[0] < pb[0] ? -1 : pa[0] > pb[0];
+}
+
+/* Sorts the copy into rows and writes it as a plaintext grid. */
+static int cell_snapshot_write(struct cell_snapshot *snap) {
+    int min_x = 0, min_y = 0, max_x = -1, max_y = -1;
+    for (size_t i = 0; i < snap->count; ++i) {
+        int x = snap->cells[2 * i];
+        int y = snap->cells[2 * i + 1];
+        min_x = i == 0 ? x : MIN(min_x, x);
+        max_x = i == 0 ? x : MAX(max_x, x);
+        min_y = i == 0 ? y : MIN(min_y, y);
+        max_y = i == 0 ? y : MAX(max_y, y);
+    }
+    long long width = (long long)max_x - min_x + 1;
+    long long height = (long long)max_y - min_y + 1;
+    if (width * height > 100000000LL) {
+        errno = EFBIG;
+        return -1;
+    }
+    qsort(snap->cells, snap->count, 2 * sizeof(int32_t), compare_cell_rows);
+
+    FILE *fp = fopen(snap->path, "w");
+    if (!fp) {
+        return -1;
+    }
+    char rule[48];
+    life_rule_format(&snap->rule, rule, sizeof(rule));
+    fprintf(fp, "#Generation %zu, rule %s, top-left cell (%d,%d)\n", snap->generation, rule, min_x, min_y);
+    char *line = malloc((size_t)width + 2);
+    if (!line) {
+        fclose(fp);
+        return -1;
+    }
+    size_t next = 0;
+    for (long long row = 0; row < height; ++row) {
+        memset(line, '.', (size_t)width);
+        for (; next < snap->count && snap->cells[2 * next + 1] == min_y + row; ++next) {
+            line[snap->cells[2 * next] - min_x] = 'O';
+        }
+        line[width] = '\n';
+        line[width + 1] = '\0';
+        fputs(line, fp);
+    }
+    free(line);
+    return fclose(fp) == 0 ? 0 : -1;
+}
+
+#define CONTROL_QUEUE_SIZE 64
+#define CONTROL_REQUEST_MAX 8192
+
+enum control_command_type {
+    CONTROL_PAUSE,
+    CONTROL_RESUME,
+    CONTROL_STEP,
+    CONTROL_LOAD,
+    CONTROL_RULE,
+    CONTROL_SNAPSHOT,
+};
+
+struct control_command {
+    enum control_command_type type;
+    size_t count;
+    char arg[PATH_MAX];
+};
+
+struct control_status {
+    size_t generation;
+    struct life_census census;
+    bool paused;
+    struct life_rule rule;
+    struct run_stats stats;
+    size_t cell_set_bytes;
+    double hash_load_factor;
+    size_t cold_tiles;
+    size_t cold_cells;
+    size_t cold_bytes;
+    uint64_t cold_evictions;
+    uint64_t cold_faults;
+    size_t tile_store_bytes;
+    uint64_t gc_collections;
+    uint64_t gc_reclaimed_bytes;
+    double gc_seconds;
+    uint64_t memo_cache_lookups;
+    uint64_t memo_cache_hits;
+    uint64_t memo_cache_results;
+    char message[128];
+};
+
+/* The HTTP thread only ever touches `queue` and `status` under `lock`; the
+   stepping thread uses trylock when publishing status so a slow client can
+   never stall a generation. */
+struct control_server {
+    int listen_fd;
+    /* /load and /snapshot only name files in this directory; empty disables them. */
+    char files_dir[PATH_MAX];
+    pthread_t thread;
+    atomic_bool stopping;
+    pthread_mutex_t lock;
+    struct control_command queue[CONTROL_QUEUE_SIZE];
+    size_t queue_head;
+    size_t queue_count;
+    struct control_status status;
+    /* Taken by the stepping thread, written out by the HTTP thread. */
+    struct cell_snapshot *snapshot;
+};
+
+static void control_status_capture(struct control_status *status, const struct life_state *life, bool paused) {
+    status->generation = life->generation;
+    status->census = life->census;
+    status->paused = paused;
+    status->rule = life->rule;
+    status->stats = life->stats;
+    status->cell_set_bytes = cell_set_memory_bytes(&life->live);
+    status->hash_load_factor = life->live.capacity ? (double)life->live.size / (double)life->live.capacity : 0.0;
+    status->cold_tiles = life->cold.size;
+    status->cold_cells = cold_store_population(&life->cold, life->generation);
+    status->cold_bytes = cold_store_bytes(&life->cold);
+    status->cold_evictions = life->cold.evictions;
+    status->cold_faults = life->cold.fault_ins;
+    status->tile_store_bytes = tile_store_bytes(&life->tile_store);
+    status->gc_collections = life->tile_store.collections;
+    status->gc_reclaimed_bytes = life->tile_store.reclaimed_bytes;
+    status->gc_seconds = life->tile_store.collect_seconds;
+    const struct memo_cache *cache = life->tile_store.cache;
+    status->memo_cache_lookups = cache ? cache->lookups : 0;
+    status->memo_cache_hits = cache ? cache->hits : 0;
+    status->memo_cache_results = cache ? cache->header->entry_count : 0;
+}
+
+static void control_update_status(struct control_server *ctl, const struct life_state *life, bool paused, const char *message) {
+    if (!ctl || pthread_mutex_trylock(&ctl->lock) != 0) {
+        return;
+    }
+    control_status_capture(&ctl->status, life, paused);
+    if (message && *message) {
+        snprintf(ctl->status.message, sizeof(ctl->status.message), "%s", message);
+    }
+    pthread_mutex_unlock(&ctl->lock);
+}
+
+static bool control_enqueue(struct control_server *ctl, const struct control_command *cmd) {
+    pthread_mutex_lock(&ctl->lock);
+    bool queued = ctl->queue_count < CONTROL_QUEUE_SIZE;
+    if (queued) {
+        ctl->queue[(ctl->queue_head + ctl->queue_count) % CONTROL_QUEUE_SIZE] = *cmd;
+        ctl->queue_count++;
+    }
+    pthread_mutex_unlock(&ctl->lock);
+    return queued;
+}
+
+static bool control_dequeue(struct control_server *ctl, struct control_command *cmd) {
+    if (pthread_mutex_trylock(&ctl->lock) != 0) {
+        return false;
+    }
+    bool found = ctl->queue_count > 0;
+    if (found) {
+        *cmd = ctl->queue[ctl->queue_head];
+        ctl->queue_head = (ctl->queue_head + 1) % CONTROL_QUEUE_SIZE;
+        ctl->queue_count--;
+    }
+    pthread_mutex_unlock(&ctl->lock);
+    return found;
+}
+
+static void control_apply_commands(struct control_server *ctl, struct life_state *life, bool *paused, size_t *pending_steps,
+                                   char *info_message, size_t info_size) {
+    if (!ctl) {
+        return;
+    }
+    struct control_command cmd;
+    while (control_dequeue(ctl, &cmd)) {
+        switch (cmd.type) {
+            case CONTROL_PAUSE:
+                *paused = true;
+                snprintf(info_message, info_size, "Paused remotely");
+                break;
+            case CONTROL_RESUME:
+                *paused = false;
+                snprintf(info_message, info_size, "Resumed remotely");
+                break;
+            case CONTROL_STEP:
+                *pending_steps += cmd.count;
+                snprintf(info_message, info_size, "Stepping %zu generations", cmd.count);
+                break;
+            case CONTROL_LOAD:
+                if (life_state_import_file(life, cmd.arg) == -1) {
+                    snprintf(info_message, info_size, "Failed to load %.80s: %s", cmd.arg, strerror(errno));
+                } else {
+                    snprintf(info_message, info_size, "Loaded %.100s", cmd.arg);
+                }
+                break;
+            case CONTROL_RULE:
+                if (life_rule_parse(cmd.arg, &life->rule)) {
+                    snprintf(info_message, info_size, "Rule set to %.47s", cmd.arg);
+                } else {
+                    snprintf(info_message, info_size, "Invalid rule %.47s", cmd.arg);
+                }
+                break;
+            case CONTROL_SNAPSHOT: {
+                /* Only the copy happens here; cold tiles stay cold. */
+                struct cell_snapshot *snap = cell_snapshot_take(life, cmd.arg);
+                pthread_mutex_lock(&ctl->lock);
+                bool busy = ctl->snapshot != NULL;
+                if (!busy) {
+                    ctl->snapshot = snap;
+                }
+                pthread_mutex_unlock(&ctl->lock);
+                if (busy) {
+                    cell_snapshot_free(snap);
+                    snprintf(info_message, info_size, "Snapshot to %.60s skipped: another is being written", cmd.arg);
+                } else {
+                    snprintf(info_message, info_size, "Snapshot of generation %zu queued for %.60s", life->generation, cmd.arg);
+                }
+                break;
+            }
+        }
+        control_update_status(ctl, life, *paused, info_message);
+    }
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+static bool query_param(const char *query, const char *name, char *value, size_t size) {
+    size_t name_len = strlen(name);
+    const char *p = query;
+    while (p && *p) {
+        const char *end = strchr(p, '&');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        if (len > name_len && strncmp(p, name, name_len) == 0 && p[name_len] == '=') {
+            size_t out = 0;
+            for (size_t i = name_len + 1; i < len && out + 1 < size; ++i) {
+                if (p[i] == '%' && i + 2 < len + 1 && hex_value(p[i + 1]) >= 0 && hex_value(p[i + 2]) >= 0) {
+                    value[out++] = (char)(hex_value(p[i + 1]) * 16 + hex_value(p[i + 2]));
+                    i += 2;
+                } else {
+                    value[out++] = p[i] == '+' ? ' ' : p[i];
+                }
+            }
+            value[out] = '\0';
+            return true;
+        }
+        p = end ? end + 1 : NULL;
+    }
+    return false;
+}
+
+static void json_escape(const char *text, char *out, size_t size) {
+    size_t len = 0;
+    for (const char *p = text; *p && len + 7 < size; ++p) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"' || c == '\\') {
+            out[len++] = '\\';
+            out[len++] = (char)c;
+        } else if (c < 0x20) {
+            len += (size_t)snprintf(out + len, size - len, "\\u%04x", c);
+        } else {
+            out[len++] = (char)c;
+        }
+    }
+    out[len] = '\0';
+}
+
+static size_t control_format_status(const struct control_status *status, char *buffer, size_t size) {
+    char message[sizeof(status->message) * 6];
+    json_escape(status->message, message, sizeof(message));
+    char rule[48];
+    life_rule_format(&status->rule, rule, sizeof(rule));
+    const struct latency_histogram *hist = &status->stats.step_latency;
+    const struct life_census *census = &status->census;
+    int len = snprintf(buffer, size,
+                       "{\"generation\":%zu,\"population\":%zu,\"births\":%zu,\"deaths\":%zu,"
+                       "\"bounds\":{\"min_x\":%d,\"min_y\":%d,\"max_x\":%d,\"max_y\":%d},\"paused\":%s,\"rule\":\"%s\","
+                       "\"generations_per_second\":%.1f,\"message\":\"%s\","
+                       "\"step_latency\":{\"count\":%llu,\"mean_ms\":%.3f,\"p50_ms\":%.3f,\"p90_ms\":%.3f,\"p99_ms\":%.3f,"
+                       "\"p999_ms\":%.3f,\"max_ms\":%.3f,\"buckets\":[",
+                       status->generation, census->population, census->births, census->deaths, census->min_x, census->min_y,
+                       census->max_x, census->max_y, status->paused ? "true" : "false", rule,
+                       status->stats.step_seconds > 0.0 ? (double)status->stats.generations / status->stats.step_seconds : 0.0,
+                       message, (unsigned long long)hist->total,
+                       hist->total ? hist->sum_seconds * 1e3 / (double)hist->total : 0.0,
+                       latency_histogram_percentile(hist, 0.50) * 1e3, latency_histogram_percentile(hist, 0.90) * 1e3,
+                       latency_histogram_percentile(hist, 0.99) * 1e3, latency_histogram_percentile(hist, 0.999) * 1e3,
+                       hist->max_seconds * 1e3);
+    bool first = true;
+    for (int b = 0; b < LATENCY_BUCKETS && len > 0 && (size_t)len < size; ++b) {
+        if (hist->counts[b] == 0) {
+            continue;
+        }
+        len += snprintf(buffer + len, size - (size_t)len, "%s{\"le_ms\":%.6f,\"count\":%llu}", first ? "" : ",",
+                        latency_bucket_upper(b) * 1e3, (unsigned long long)hist->counts[b]);
+        first = false;
+    }
+    if (len > 0 && (size_t)len < size) {
+        const uint64_t *escapees = status->stats.escapees;
+        len += snprintf(buffer + len, size - (size_t)len,
+                        "]},\"escapees\":{\"%s\":%llu,\"%s\":%llu,\"%s\":%llu,\"%s\":%llu}", SHIP_NAMES[SHIP_GLIDER],
+                        (unsigned long long)escapees[SHIP_GLIDER], SHIP_NAMES[SHIP_LWSS], (unsigned long long)escapees[SHIP_LWSS],
+                        SHIP_NAMES[SHIP_MWSS], (unsigned long long)escapees[SHIP_MWSS], SHIP_NAMES[SHIP_HWSS],
+                        (unsigned long long)escapees[SHIP_HWSS]);
+    }
+    if (len > 0 && (size_t)len < size) {
+        len += snprintf(buffer + len, size - (size_t)len, ",\"memory\":{\"rss_bytes\":%zu,\"cell_set_bytes\":%zu,\"cold_tiles\":%zu,\"cold_cells\":%zu,\"cold_bytes\":%zu,\"tile_store_bytes\":%zu},"
+                        "\"gc\":{\"collections\":%llu,\"seconds\":%.6f,\"reclaimed_bytes\":%llu},"
+                        "\"memo_cache\":{\"lookups\":%llu,\"hits\":%llu,\"results\":%llu}}\n",
+                        process_resident_bytes(), status->cell_set_bytes, status->cold_tiles, status->cold_cells, status->cold_bytes,
+                        status->tile_store_bytes, (unsigned long long)status->gc_collections, status->gc_seconds,
+                        (unsigned long long)status->gc_reclaimed_bytes, (unsigned long long)status->memo_cache_lookups,
+                        (unsigned long long)status->memo_cache_hits, (unsigned long long)status->memo_cache_results);
+    }
+    return len > 0 ? MIN((size_t)len, size - 1) : 0;
+}
+
+static void metrics_write_histogram(FILE *out, const char *name, const char *help, const struct latency_histogram *hist) {
+    fprintf(out, "# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+    /* Only every fourth bucket edge (the powers of two) is exported, which is
+       plenty for dashboards and keeps the series count small. */
+    uint64_t cumulative = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; ++b) {
+        cumulative += hist->counts[b];
+        if (b % 4 == 3 && b >= 39) {
+            fprintf(out, "%s_bucket{le=\"%.9g\"} %llu\n", name, latency_bucket_upper(b), (unsigned long long)cumulative);
+        }
+    }
+    fprintf(out, "%s_bucket{le=\"+Inf\"} %llu\n", name, (unsigned long long)hist->total);
+    fprintf(out, "%s_sum %.9f\n%s_count %llu\n", name, hist->sum_seconds, name, (unsigned long long)hist->total);
+}
+
+static void metrics_write(FILE *out, const struct control_status *status) {
+    fprintf(out, "# HELP gameoflife_generations_total Generations stepped since start.\n");
+    fprintf(out, "# TYPE gameoflife_generations_total counter\ngameoflife_generations_total %llu\n",
+            (unsigned long long)status->stats.generations);
+    fprintf(out, "# HELP gameoflife_cells_updated_total Cell states evaluated by the steppers.\n");
+    fprintf(out, "# TYPE gameoflife_cells_updated_total counter\ngameoflife_cells_updated_total %llu\n",
+            (unsigned long long)atomic_load_explicit(&counters.cells_updated, memory_order_relaxed));
+    fprintf(out, "# HELP gameoflife_allocations_total Heap allocations of cells, neighbour counts and tiles.\n");
+    fprintf(out, "# TYPE gameoflife_allocations_total counter\ngameoflife_allocations_total %llu\n",
+            (unsigned long long)atomic_load_explicit(&counters.allocations, memory_order_relaxed));
+    fprintf(out, "# HELP gameoflife_generation Current generation number.\n");
+    fprintf(out, "# TYPE gameoflife_generation gauge\ngameoflife_generation %zu\n", status->generation);
+    fprintf(out, "# HELP gameoflife_population Live cells in the current generation.\n");
+    fprintf(out, "# TYPE gameoflife_population gauge\ngameoflife_population %zu\n", status->census.population);
+    fprintf(out, "# HELP gameoflife_births Cells born in the last stepping call.\n");
+    fprintf(out, "# TYPE gameoflife_births gauge\ngameoflife_births %zu\n", status->census.births);
+    fprintf(out, "# HELP gameoflife_deaths Cells that died in the last stepping call.\n");
+    fprintf(out, "# TYPE gameoflife_deaths gauge\ngameoflife_deaths %zu\n", status->census.deaths);
+    fprintf(out, "# HELP gameoflife_bounding_box_width Width of the live cells' bounding box.\n");
+    fprintf(out, "# TYPE gameoflife_bounding_box_width gauge\ngameoflife_bounding_box_width %lld\n",
+            status->census.population ? (long long)status->census.max_x - status->census.min_x + 1 : 0);
+    fprintf(out, "# HELP gameoflife_bounding_box_height Height of the live cells' bounding box.\n");
+    fprintf(out, "# TYPE gameoflife_bounding_box_height gauge\ngameoflife_bounding_box_height %lld\n",
+            status->census.population ? (long long)status->census.max_y - status->census.min_y + 1 : 0);
+    fprintf(out, "# HELP gameoflife_tracked_tile_steps_total Tile steps of the one-generation stepper with phase tracking on.\n");
+    fprintf(out, "# TYPE gameoflife_tracked_tile_steps_total counter\ngameoflife_tracked_tile_steps_total %llu\n",
+            (unsigned long long)status->stats.tracked_tile_steps);
+    fprintf(out, "# HELP gameoflife_periodic_tile_steps_total Tile steps copied from a periodic tile's phase history.\n");
+    fprintf(out, "# TYPE gameoflife_periodic_tile_steps_total counter\ngameoflife_periodic_tile_steps_total %llu\n",
+            (unsigned long long)status->stats.periodic_tile_steps);
+    fprintf(out, "# HELP gameoflife_escapees_total Escaping spaceships removed from the pattern.\n");
+    fprintf(out, "# TYPE gameoflife_escapees_total counter\n");
+    for (int kind = 0; kind < SHIP_KINDS; ++kind) {
+        fprintf(out, "gameoflife_escapees_total{kind=\"%s\"} %llu\n", SHIP_NAMES[kind],
+                (unsigned long long)status->stats.escapees[kind]);
+    }
+    fprintf(out, "# HELP gameoflife_hash_load_factor Fraction of the live cell set's slots in use.\n");
+    fprintf(out, "# TYPE gameoflife_hash_load_factor gauge\ngameoflife_hash_load_factor %.6f\n", status->hash_load_factor);
+    fprintf(out, "# HELP gameoflife_cell_set_bytes Memory held by the live cell set.\n");
+    fprintf(out, "# TYPE gameoflife_cell_set_bytes gauge\ngameoflife_cell_set_bytes %zu\n", status->cell_set_bytes);
+    fprintf(out, "# HELP gameoflife_cold_tiles Settled tiles held in the on-disk cold store.\n");
+    fprintf(out, "# TYPE gameoflife_cold_tiles gauge\ngameoflife_cold_tiles %zu\n", status->cold_tiles);
+    fprintf(out, "# HELP gameoflife_cold_bytes Bytes holding cold tiles: the store file, or the compressed codes.\n");
+    fprintf(out, "# TYPE gameoflife_cold_bytes gauge\ngameoflife_cold_bytes %zu\n", status->cold_bytes);
+    fprintf(out, "# HELP gameoflife_cold_evictions_total Tiles written to the cold store.\n");
+    fprintf(out, "# TYPE gameoflife_cold_evictions_total counter\ngameoflife_cold_evictions_total %llu\n",
+            (unsigned long long)status->cold_evictions);
+    fprintf(out, "# HELP gameoflife_cold_faults_total Tiles faulted back in from the cold store.\n");
+    fprintf(out, "# TYPE gameoflife_cold_faults_total counter\ngameoflife_cold_faults_total %llu\n",
+            (unsigned long long)status->cold_faults);
+    fprintf(out, "# HELP gameoflife_tile_store_bytes Memory held by interned tile contents and the step memo.\n");
+    fprintf(out, "# TYPE gameoflife_tile_store_bytes gauge\ngameoflife_tile_store_bytes %zu\n", status->tile_store_bytes);
+    fprintf(out, "# HELP gameoflife_gc_collections_total Tile store garbage collections.\n");
+    fprintf(out, "# TYPE gameoflife_gc_collections_total counter\ngameoflife_gc_collections_total %llu\n",
+            (unsigned long long)status->gc_collections);
+    fprintf(out, "# HELP gameoflife_gc_seconds_total Time spent collecting the tile store.\n");
+    fprintf(out, "# TYPE gameoflife_gc_seconds_total counter\ngameoflife_gc_seconds_total %.6f\n", status->gc_seconds);
+    fprintf(out, "# HELP gameoflife_gc_reclaimed_bytes_total Tile contents and memo entries freed by collections.\n");
+    fprintf(out, "# TYPE gameoflife_gc_reclaimed_bytes_total counter\ngameoflife_gc_reclaimed_bytes_total %llu\n",
+            (unsigned long long)status->gc_reclaimed_bytes);
+    fprintf(out, "# HELP gameoflife_memo_cache_lookups_total Memo misses looked up in the --memo-cache file.\n");
+    fprintf(out, "# TYPE gameoflife_memo_cache_lookups_total counter\ngameoflife_memo_cache_lookups_total %llu\n",
+            (unsigned long long)status->memo_cache_lookups);
+    fprintf(out, "# HELP gameoflife_memo_cache_hits_total Memo misses answered by the --memo-cache file.\n");
+    fprintf(out, "# TYPE gameoflife_memo_cache_hits_total counter\ngameoflife_memo_cache_hits_total %llu\n",
+            (unsigned long long)status->memo_cache_hits);
+    fprintf(out, "# HELP gameoflife_memo_cache_results Step results held in the --memo-cache file.\n");
+    fprintf(out, "# TYPE gameoflife_memo_cache_results gauge\ngameoflife_memo_cache_results %llu\n",
+            (unsigned long long)status->memo_cache_results);
+    fprintf(out, "# HELP gameoflife_huge_page_bytes Process memory backed by transparent or hugetlbfs huge pages.\n");
+    fprintf(out, "# TYPE gameoflife_huge_page_bytes gauge\ngameoflife_huge_page_bytes %zu\n", process_huge_page_bytes());
+    fprintf(out, "# HELP gameoflife_resident_memory_bytes Resident set size of the process.\n");
+    fprintf(out, "# TYPE gameoflife_resident_memory_bytes gauge\ngameoflife_resident_memory_bytes %zu\n", process_resident_bytes());
+    metrics_write_histogram(out, "gameoflife_step_duration_seconds", "Wall time of each generation, or of each block of the multi-generation stepper.", &status->stats.step_latency);
+    metrics_write_histogram(out, "gameoflife_render_duration_seconds", "Wall time of each rendered frame.",
+                            &status->stats.render_latency);
+}
+
+static void control_respond_typed(int fd, int code, const char *reason, const char *content_type, const char *body) {
+    char header[256];
+    int len = snprintf(header, sizeof(header),
+                       "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n", code,
+                       reason, content_type, strlen(body));
+    if (send(fd, header, (size_t)len, MSG_NOSIGNAL) == len) {
+        send(fd, body, strlen(body), MSG_NOSIGNAL);
+    }
+}
+
+static void control_respond(int fd, int code, const char *reason, const char *body) {
+    control_respond_typed(fd, code, reason, "application/json", body);
+}
+
+/* Copies the value of header `name` (case-insensitive) out of `request`. */
+static bool control_header(const char *request, const char *name, char *value, size_t size) {
+    size_t name_len = strlen(name);
+    const char *line = strchr(request, '\n');
+    while (line && line[1] != '\0' && line[1] != '\r' && line[1] != '\n') {
+        line++;
+        if (strncasecmp(line, name, name_len) == 0 && line[name_len] == ':') {
+            const char *p = line + name_len + 1;
+            while (*p == ' ' || *p == '\t') {
+                p++;
+            }
+            size_t out = 0;
+            while (*p && *p != '\r' && *p != '\n' && out + 1 < size) {
+                value[out++] = *p++;
+            }
+            value[out] = '\0';
+            return true;
+        }
+        line = strchr(line, '\n');
+    }
+    return false;
+}
+
+/* Browsers always send Host, so a loopback-only Host keeps out pages that
+   reach this port through a rebound DNS name. */
+static bool control_host_allowed(const char *host) {
+    static const char *const names[] = {"127.0.0.1", "localhost", "[::1]"};
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        size_t len = strlen(names[i]);
+        if (strncasecmp(host, names[i], len) == 0 &&
+            (host[len] == '\0' || (host[len] == ':' && host[len + 1] != '\0' && strspn(host + len + 1, "0123456789") == strlen(host + len + 1)))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* A file argument is a plain name inside files_dir: no separators and no
+   leading dot, so it can neither climb out nor name a hidden file. */
+static bool control_file_name_valid(const char *name) {
+    return name[0] != '\0' && name[0] != '.' &&
+           strspn(name, "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789._-") == strlen(name);
+}
+
+static void control_handle_request(struct control_server *ctl, int fd, char *request) {
+    char method[8];
+    char target[1024];
+    if (sscanf(request, "%7s %1023s", method, target) != 2) {
+        control_respond(fd, 400, "Bad Request", "{\"error\":\"malformed request\"}\n");
+        return;
+    }
+    /* Any web page can make the browser send requests here; only those
+       carry an Origin header, so such requests are refused outright. */
+    char header[256];
+    if (control_header(request, "Origin", header, sizeof(header)) ||
+        (control_header(request, "Host", header, sizeof(header)) && !control_host_allowed(header))) {
+        control_respond(fd, 403, "Forbidden", "{\"error\":\"cross-origin or non-loopback request\"}\n");
+        return;
+    }
+    char *query = strchr(target, '?');
+    if (query) {
+        *query++ = '\0';
+    }
+    bool is_get = strcmp(method, "GET") == 0;
+    bool is_post = strcmp(method, "POST") == 0;
+
+    if (strcmp(target, "/status") == 0 || strcmp(target, "/") == 0) {
+        if (!is_get) {
+            control_respond(fd, 405, "Method Not Allowed", "{\"error\":\"use GET\"}\n");
+            return;
+        }
+        char body[16384];
+        pthread_mutex_lock(&ctl->lock);
+        struct control_status status = ctl->status;
+        pthread_mutex_unlock(&ctl->lock);
+        control_format_status(&status, body, sizeof(body));
+        control_respond(fd, 200, "OK", body);
+        return;
+    }
+
+    if (strcmp(target, "/metrics") == 0) {
+        if (!is_get) {
+            control_respond(fd, 405, "Method Not Allowed", "{\"error\":\"use GET\"}\n");
+            return;
+        }
+        pthread_mutex_lock(&ctl->lock);
+        struct control_status status = ctl->status;
+        pthread_mutex_unlock(&ctl->lock);
+        char *body = NULL;
+        size_t body_size = 0;
+        FILE *out = open_memstream(&body, &body_size);
+        if (!out) {
+            control_respond(fd, 500, "Internal Server Error", "{\"error\":\"out of memory\"}\n");
+            return;
+        }
+        metrics_write(out, &status);
+        fclose(out);
+        control_respond_typed(fd, 200, "OK", "text/plain; version=0.0.4", body);
+        free(body);
+        return;
+    }
+
+    struct control_command cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    if (strcmp(target, "/pause") == 0) {
+        cmd.type = CONTROL_PAUSE;
+    } else if (strcmp(target, "/resume") == 0) {
+        cmd.type = CONTROL_RESUME;
+    } else if (strcmp(target, "/step") == 0) {
+        char value[32] = "1";
+        query_param(query, "n", value, sizeof(value));
+        char *end = NULL;
+        unsigned long long count = strtoull(value, &end, 10);
+        if (!end || *end != '\0' || count == 0) {
+            control_respond(fd, 400, "Bad Request", "{\"error\":\"n must be a positive integer\"}\n");
+            return;
+        }
+        cmd.type = CONTROL_STEP;
+        cmd.count = (size_t)count;
+    } else if (strcmp(target, "/load") == 0 || strcmp(target, "/snapshot") == 0 || strcmp(target, "/rule") == 0) {
+        bool rule = strcmp(target, "/rule") == 0;
+        if (!rule && ctl->files_dir[0] == '\0') {
+            control_respond(fd, 403, "Forbidden", "{\"error\":\"file commands need --http-dir\"}\n");
+            return;
+        }
+        if (!query_param(query, rule ? "rule" : "path", cmd.arg, sizeof(cmd.arg)) || cmd.arg[0] == '\0') {
+            control_respond(fd, 400, "Bad Request", rule ? "{\"error\":\"missing rule\"}\n" : "{\"error\":\"missing path\"}\n");
+            return;
+        }
+        struct life_rule parsed;
+        if (rule && !life_rule_parse(cmd.arg, &parsed)) {
+            control_respond(fd, 400, "Bad Request", "{\"error\":\"invalid rule\"}\n");
+            return;
+        }
+        if (!rule) {
+            if (!control_file_name_valid(cmd.arg)) {
+                control_respond(fd, 400, "Bad Request", "{\"error\":\"path must be a plain file name\"}\n");
+                return;
+            }
+            size_t name_len = strlen(cmd.arg);
+            if (name_len > NAME_MAX) {
+                control_respond(fd, 400, "Bad Request", "{\"error\":\"file name too long\"}\n");
+                return;
+            }
+            char name[NAME_MAX + 1];
+            memcpy(name, cmd.arg, name_len + 1);
+            if ((size_t)snprintf(cmd.arg, sizeof(cmd.arg), "%s/%s", ctl->files_dir, name) >= sizeof(cmd.arg)) {
+                control_respond(fd, 400, "Bad Request", "{\"error\":\"path too long\"}\n");
+                return;
+            }
+        }
+        cmd.type = rule ? CONTROL_RULE : strcmp(target, "/load") == 0 ? CONTROL_LOAD : CONTROL_SNAPSHOT;
+    } else {
+        control_respond(fd, 404, "Not Found", "{\"error\":\"unknown endpoint\"}\n");
+        return;
+    }
+    if (!is_post) {
+        control_respond(fd, 405, "Method Not Allowed", "{\"error\":\"use POST\"}\n");
+        return;
+    }
+    if (!control_enqueue(ctl, &cmd)) {
+        control_respond(fd, 503, "Service Unavailable", "{\"error\":\"command queue full\"}\n");
+        return;
+    }
+    control_respond(fd, 202, "Accepted", "{\"queued\":true}\n");
+}
+
+static void *control_server_main(void *arg) {
+    struct control_server *ctl = arg;
+    char request[CONTROL_REQUEST_MAX];
+    while (!atomic_load(&ctl->stopping)) {
+        pthread_mutex_lock(&ctl->lock);
+        struct cell_snapshot *snap = ctl->snapshot;
+        pthread_mutex_unlock(&ctl->lock);
+        if (snap) {
+            char message[sizeof(ctl->status.message)];
+            if (cell_snapshot_write(snap) == -1) {
+                snprintf(message, sizeof(message), "Snapshot to %.80s failed: %s", snap->path, strerror(errno));
+            } else {
+                snprintf(message, sizeof(message), "Snapshot written to %.90s", snap->path);
+            }
+            pthread_mutex_lock(&ctl->lock);
+            snprintf(ctl->status.message, sizeof(ctl->status.message), "%s", message);
+            ctl->snapshot = NULL;
+            pthread_mutex_unlock(&ctl->lock);
+            cell_snapshot_free(snap);
+        }
+        struct pollfd pfd = {ctl->listen_fd, POLLIN, 0};
+        if (poll(&pfd, 1, 200) <= 0) {
+            continue;
+        }
+        int fd = accept(ctl->listen_fd, NULL, NULL);
+        if (fd == -1) {
+            continue;
+        }
+        struct timeval timeout = {2, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        size_t len = 0;
+        while (len + 1 < sizeof(request)) {
+            ssize_t got = recv(fd, request + len, sizeof(request) - 1 - len, 0);
+            if (got <= 0) {
+                break;
+            }
+            len += (size_t)got;
+            request[len] = '\0';
+            if (strstr(request, "\r\n\r\n") || strstr(request, "\n\n")) {
+                break;
+            }
+        }
+        request[len] = '\0';
+        if (len > 0) {
+            control_handle_request(ctl, fd, request);
+        }
+        close(fd);
+    }
+    return NULL;
+}
+
+static struct control_server *control_server_create(int port, const char *files_dir) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == -1) {
+        perror("socket");
+        return NULL;
+    }
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 || listen(fd, 16) == -1) {
+        fprintf(stderr, "Cannot listen on 127.0.0.1:%d: %s\n", port, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+
+    struct control_server *ctl = calloc(1, sizeof(*ctl));
+    if (!ctl) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    ctl->listen_fd = fd;
+    if (files_dir) {
+        snprintf(ctl->files_dir, sizeof(ctl->files_dir), "%s", files_dir);
+    }
+    atomic_init(&ctl->stopping, false);
+    pthread_mutex_init(&ctl->lock, NULL);
+    int err = pthread_create(&ctl->thread, NULL, control_server_main, ctl);
+    if (err != 0) {
+        fprintf(stderr, "pthread_create: %s\n", strerror(err));
+        exit(EXIT_FAILURE);
+    }
+    return ctl;
+}
+
+static void control_server_destroy(struct control_server *ctl) {
+    if (!ctl) {
+        return;
+    }
+    atomic_store(&ctl->stopping, true);
+    pthread_join(ctl->thread, NULL);
+    close(ctl->listen_fd);
+    cell_snapshot_free(ctl->snapshot);
+    pthread_mutex_destroy(&ctl->lock);
+    free(ctl);
+}
+
+static void metrics_dump(struct life_state *life, bool paused, bool force) {
+    if (!life->metrics_path) {
+        return;
+    }
+    double now = monotonic_seconds();
+    if (!force && now - life->metrics_written < METRICS_DUMP_INTERVAL) {
+        return;
+    }
+    life->metrics_written = now;
+
+    char temp_path[PATH_MAX];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", life->metrics_path);
+    FILE *fp = fopen(temp_path, "w");
+    if (!fp) {
+        return;
+    }
+    struct control_status status;
+    control_status_capture(&status, life, paused);
+    metrics_write(fp, &status);
+    if (fclose(fp) == 0) {
+        rename(temp_path, life->metrics_path);
+    } else {
+        unlink(temp_path);
+    }
+}
+
+struct view_state {
+    int center_x;
+    int center_y;
+    int scale;
+    double fractional_x;
+    double fractional_y;
+    bool follow;
+};
+
+static void view_init(struct view_state *view) {
+    view->center_x = 0;
+    view->center_y = 0;
+    view->scale = 1;
+    view->fractional_x = 0.0;
+    view->fractional_y = 0.0;
+    view->follow = false;
+}
+
+static void view_zoom_in(struct view_state *view) {
+    view->scale = MAX(1, view->scale / 2);
+}
+
+static void view_zoom_out(struct view_state *view) {
+    if (view->scale < 1024) {
+        view->scale *= 2;
+    }
+}
+
+static void view_pan(struct view_state *view, int dx, int dy) {
+    view->center_x += dx * view->scale;
+    view->center_y += dy * view->scale;
+    view->fractional_x = 0.0;
+    view->fractional_y = 0.0;
+    view->follow = false;
+}
+
+/* `cols` and `rows` are how many cells fit on screen at scale 1. */
+static bool view_fit(struct view_state *view, const struct life_census *census, int cols, int rows) {
+    if (census->population == 0) {
+        return false;
+    }
+    int64_t width = (int64_t)census->max_x - census->min_x + 1;
+    int64_t height = (int64_t)census->max_y - census->min_y + 1;
+    int scale = 1;
+    while (scale < 1024 && (width > (int64_t)cols * scale || height > (int64_t)rows * scale)) {
+        scale *= 2;
+    }
+    view->scale = scale;
+    view->center_x = (int)(((int64_t)census->min_x + census->max_x) / 2);
+    view->center_y = (int)(((int64_t)census->min_y + census->max_y) / 2);
+    view->fractional_x = 0.0;
+    view->fractional_y = 0.0;
+    return true;
+}
+
+static void view_follow(struct view_state *view, const struct life_census *census) {
+    size_t changed = census->births + census->deaths;
+    if (!view->follow || changed == 0) {
+        return;
+    }
+    view->center_x = (int)(census->change_sum_x / (int64_t)changed);
+    view->center_y = (int)(census->change_sum_y / (int64_t)changed);
+    view->fractional_x = 0.0;
+    view->fractional_y = 0.0;
+}
+
+static void view_pan_pixels(struct view_state *view, double dx_pixels, double dy_pixels) {
+    if (dx_pixels == 0.0 && dy_pixels == 0.0) {
+        return;
+    }
+
+    double scaled_dx = dx_pixels * (double)view->scale / (double)BASE_TILE_PIXELS;
+    double scaled_dy = dy_pixels * (double)view->scale / (double)BASE_TILE_PIXELS;
+
+    view->fractional_x += scaled_dx;
+    view->fractional_y += scaled_dy;
+
+    while (view->fractional_x >= 1.0) {
+        view->center_x += 1;
+        view->fractional_x -= 1.0;
+    }
+    while (view->fractional_x <= -1.0) {
+        view->center_x -= 1;
+        view->fractional_x += 1.0;
+    }
+
+    while (view->fractional_y >= 1.0) {
+        view->center_y += 1;
+        view->fractional_y -= 1.0;
+    }
+    while (view->fractional_y <= -1.0) {
+        view->center_y -= 1;
+        view->fractional_y += 1.0;
+    }
+}
+
+static void clear_screen(void) {
+    printf("\033[2J\033[H");
+}
+
+static void terminal_view_size(int *cols, int *rows) {
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == -1) {
+        ws.ws_col = 80;
+        ws.ws_row = 24;
+    }
+    *rows = ws.ws_row > 5 ? ws.ws_row - 5 : ws.ws_row;
+    *cols = ws.ws_col;
+}
+
+/* Hexagonal rules live on Golly's skewed grid. Drawing cell (x, y) at
+   half-cell column 2x - y shears it back into a honeycomb: each cell spans
+   two character columns and every row sits half a cell left of the one
+   above it. */
+static void render_hex_row_terminal(const struct cell_set *live, int y, int first, int cols) {
+    uint64_t keys[LOOKUP_BATCH];
+    bool found[LOOKUP_BATCH];
+    int batch = LOOKUP_BATCH;
+    for (int col = 0; col < cols; ++col) {
+        int p = first + col;
+        if (((p + y) & 1) != 0) {
+            putchar(' ');
+            continue;
+        }
+        if (batch == LOOKUP_BATCH) {
+            size_t n = 0;
+            for (int q = p; q < first + cols && n < LOOKUP_BATCH; q += 2) {
+                keys[n++] = cell_key((q + y) / 2, y);
+            }
+            cell_set_contains_batch(live, keys, n, found);
+            batch = 0;
+        }
+        putchar(found[batch++] ? 'O' : '.');
+    }
+}
+
+static void render_state_terminal(const struct life_state *life, const struct view_state *view, bool paused, int delay_ms, const char *info_message) {
+    int cols, rows;
+    terminal_view_size(&cols, &rows);
+
+    clear_screen();
+
+    int half_rows = rows / 2;
+    int half_cols = cols / 2;
+
+    bool hex = life->rule.neighbourhood == NEIGHBOURHOOD_HEXAGONAL && view->scale == 1;
+    for (int row = 0; row < rows; ++row) {
+        if (hex) {
+            render_hex_row_terminal(&life->live, view->center_y - half_rows + row, 2 * view->center_x - view->center_y - half_cols,
+                                    cols);
+            putchar('\n');
+            continue;
+        }
+        uint64_t keys[LOOKUP_BATCH];
+        bool found[LOOKUP_BATCH];
+        for (int col = 0; col < cols; ++col) {
+            int origin_x = view->center_x - half_cols * view->scale + col * view->scale;
+            int origin_y = view->center_y - half_rows * view->scale + row * view->scale;
+            if (view->scale == 1) {
+                int batch = col % LOOKUP_BATCH;
+                if (batch == 0) {
+                    int n = MIN(LOOKUP_BATCH, cols - col);
+                    for (int i = 0; i < n; ++i) {
+                        keys[i] = cell_key(origin_x + i, origin_y);
+                    }
+                    cell_set_contains_batch(&life->live, keys, (size_t)n, found);
+                }
+                putchar(found[batch] ? 'O' : '.');
+                continue;
+            }
+            bool alive = false;
+            for (int dy = 0; dy < view->scale && !alive; ++dy) {
+                for (int dx = 0; dx < view->scale; ++dx) {
+                    if (cell_set_contains(&life->live, origin_x + dx, origin_y + dy)) {
+                        alive = true;
+                        break;
+                    }
+                }
+            }
+            putchar(alive ? 'O' : '.');
+        }
+        putchar('\n');
+    }
+
+    char rule[48];
+    life_rule_format(&life->rule, rule, sizeof(rule));
+    const struct life_census *census = &life->census;
+    printf("Generation: %zu | Live cells: %zu | Births: %zu | Deaths: %zu | Bounds: (%d,%d)-(%d,%d) | Rule: %s\n", life->generation,
+           census->population, census->births, census->deaths, census->min_x, census->min_y, census->max_x, census->max_y, rule);
+    printf("Speed: %d ms | Scale: %d | Center: (%d,%d)\n", delay_ms, view->scale, view->center_x, view->center_y);
+    printf("Status: %s%s | Controls: q=quit p=pause/resume n=step w/a/s/d=pan +/-=zoom | r=reset to origin f=fit c=follow\n",
+           paused ? "paused" : "running", view->follow ? " (following)" : "");
+    if (info_message && *info_message) {
+        printf("Info: %s\n", info_message);
+    } else {
+        printf("Info: \n");
+    }
+    fflush(stdout);
+}
+
+/* Same shear as the terminal: each row of cells is drawn half a cell left of
+   the row above, which turns the skewed grid into staggered hexagons. */
+static void render_hex_sdl(SDL_Renderer *renderer, const struct cell_set *live, const struct view_state *view, int cols, int rows,
+                           int tile_pixels) {
+    int half_cols = cols / 2;
+    int half_rows = rows / 2;
+    for (int row = 0; row < rows; ++row) {
+        int y = view->center_y - half_rows + row;
+        int dy = y - view->center_y;
+        int shift = dy * tile_pixels / 2;
+        int first = view->center_x - half_cols + (dy >= 0 ? dy / 2 : -((1 - dy) / 2)) - 1;
+        int count = cols + 2;
+        for (int base = 0; base < count; base += LOOKUP_BATCH) {
+            uint64_t keys[LOOKUP_BATCH];
+            bool found[LOOKUP_BATCH];
+            int n = MIN(LOOKUP_BATCH, count - base);
+            for (int i = 0; i < n; ++i) {
+                keys[i] = cell_key(first + base + i, y);
+            }
+            cell_set_contains_batch(live, keys, (size_t)n, found);
+            for (int i = 0; i < n; ++i) {
+                int x = first + base + i;
+                SDL_Rect rect = {(x - view->center_x + half_cols) * tile_pixels - shift, row * tile_pixels, tile_pixels, tile_pixels};
+                SDL_SetRenderDrawColor(renderer, 72, 72, 72, 255);
+                SDL_RenderDrawRect(renderer, &rect);
+                if (found[i]) {
+                    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+                    SDL_RenderFillRect(renderer, &rect);
+                }
+            }
+        }
+    }
+}
+
+static void render_state_sdl(SDL_Renderer *renderer, const struct life_state *life, const struct view_state *view, int window_w, int window_h) {
+    const int threshold_scale = MAX(1, BASE_TILE_PIXELS / MIN_DISTINGUISHABLE_PIXELS);
+
+    int cell_span;
+    int tile_pixels;
+    if (view->scale <= threshold_scale) {
+        cell_span = 1;
+        tile_pixels = BASE_TILE_PIXELS / view->scale;
+        if (tile_pixels < 1) {
+            tile_pixels = 1;
+        }
+    } else {
+        cell_span = (view->scale + threshold_scale - 1) / threshold_scale;
+        tile_pixels = BASE_TILE_PIXELS / threshold_scale;
+        if (tile_pixels < 1) {
+            tile_pixels = 1;
+        }
+    }
+
+    int cols = (window_w + tile_pixels - 1) / tile_pixels;
+    int rows = (window_h + tile_pixels - 1) / tile_pixels;
+    if (cols < 1) {
+        cols = 1;
+    }
+    if (rows < 1) {
+        rows = 1;
+    }
+
+    int half_cols = cols / 2;
+    int half_rows = rows / 2;
+
+    SDL_SetRenderDrawColor(renderer, 16, 16, 24, 255);
+    SDL_RenderClear(renderer);
+
+    if (life->rule.neighbourhood == NEIGHBOURHOOD_HEXAGONAL && cell_span == 1) {
+        render_hex_sdl(renderer, &life->live, view, cols, rows, tile_pixels);
+        return;
+    }
+
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    for (int row = 0; row < rows; ++row) {
+        uint64_t keys[LOOKUP_BATCH];
+        bool found[LOOKUP_BATCH];
+        for (int col = 0; col < cols; ++col) {
+            int origin_x = view->center_x - half_cols * cell_span + col * cell_span;
+            int origin_y = view->center_y - half_rows * cell_span + row * cell_span;
+            bool alive = false;
+            if (cell_span == 1) {
+                int batch = col % LOOKUP_BATCH;
+                if (batch == 0) {
+                    int n = MIN(LOOKUP_BATCH, cols - col);
+                    for (int i = 0; i < n; ++i) {
+                        keys[i] = cell_key(origin_x + i, origin_y);
+                    }
+                    cell_set_contains_batch(&life->live, keys, (size_t)n, found);
+                }
+                alive = found[batch];
+            } else {
+                for (int dy = 0; dy < cell_span && !alive; ++dy) {
+                    for (int dx = 0; dx < cell_span; ++dx) {
+                        if (cell_set_contains(&life->live, origin_x + dx, origin_y + dy)) {
+                            alive = true;
+                            break;
+                        }
+                    }
+                }
+            }
+            if (alive) {
+                SDL_Rect rect = {col * tile_pixels, row * tile_pixels, tile_pixels, tile_pixels};
+                SDL_RenderFillRect(renderer, &rect);
+            }
+        }
+    }
+
+    SDL_SetRenderDrawColor(renderer, 72, 72, 72, 255);
+    int render_width = cols * tile_pixels;
+    int render_height = rows * tile_pixels;
+    if (render_width < window_w) {
+        render_width = window_w;
+    }
+    if (render_height < window_h) {
+        render_height = window_h;
+    }
+    for (int col = 0; col <= cols; ++col) {
+        int x = col * tile_pixels;
+        SDL_RenderDrawLine(renderer, x, 0, x, render_height);
+    }
+    for (int row = 0; row <= rows; ++row) {
+        int y = row * tile_pixels;
+        SDL_RenderDrawLine(renderer, 0, y, render_width, y);
+    }
+}
+
+static int run_terminal(struct life_state *life, int delay_ms) {
+    setup_terminal();
+
+    struct view_state view;
+    view_init(&view);
+
+    bool paused = false;
+    bool single_step = false;
+    size_t pending_steps = 0;
+    bool running = true;
+    char info_message[128] = "Press q to quit, p to pause.";
+
+    render_state_terminal(life, &view, paused, delay_ms, info_message);
+    info_message[0] = '\0';
+
+    while (running) {
+        ssize_t bytes = 0;
+        char ch;
+        while ((bytes = read(STDIN_FILENO, &ch, 1)) > 0) {
+            if (ch == 'q') {
+                running = false;
+                break;
+            } else if (ch == 'p') {
+                paused = !paused;
+            } else if (ch == 'n') {
+                single_step = true;
+            } else if (ch == 'w') {
+                view_pan(&view, 0, -1);
+            } else if (ch == 's') {
+                view_pan(&view, 0, 1);
+            } else if (ch == 'a') {
+                view_pan(&view, -1, 0);
+            } else if (ch == 'd') {
+                view_pan(&view, 1, 0);
+            } else if (ch == '+' || ch == '=') {
+                view_zoom_in(&view);
+            } else if (ch == '-') {
+                view_zoom_out(&view);
+            } else if (ch == 'r') {
+                view_init(&view);
+                snprintf(info_message, sizeof(info_message), "View reset to origin");
+            } else if (ch == 'f') {
+                int cols, rows;
+                terminal_view_size(&cols, &rows);
+                if (life->rule.neighbourhood == NEIGHBOURHOOD_HEXAGONAL) {
+                    /* The hexagonal renderer spends two columns per cell. */
+                    cols = MAX(1, cols / 2);
+                }
+                view.follow = false;
+                if (view_fit(&view, &life->census, cols, rows)) {
+                    snprintf(info_message, sizeof(info_message), "View fitted to live cells");
+                }
+            } else if (ch == 'c') {
+                view.follow = !view.follow;
+                snprintf(info_message, sizeof(info_message), "Follow mode %s", view.follow ? "on" : "off");
+            }
+        }
+
+        if (bytes == -1 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            perror("read");
+            running = false;
+            break;
+        }
+
+        control_apply_commands(life->control, life, &paused, &pending_steps, info_message, sizeof(info_message));
+
+        if ((!paused) || single_step) {
+            life_state_advance(life, 1);
+            single_step = false;
+        } else if (pending_steps > 0) {
+            size_t chunk = MIN(pending_steps, (size_t)INTERACTIVE_STEP_CHUNK);
+            life_state_advance(life, chunk);
+            pending_steps -= chunk;
+        }
+        view_follow(&view, &life->census);
+        control_update_status(life->control, life, paused, NULL);
+
+        double render_start = monotonic_seconds();
+        render_state_terminal(life, &view, paused, delay_ms, info_message);
+        latency_histogram_record(&life->stats.render_latency, monotonic_seconds() - render_start);
+        info_message[0] = '\0';
+        metrics_dump(life, paused, false);
+
+        if (delay_ms > 0) {
+            struct timespec req = {delay_ms / 1000, (delay_ms % 1000) * 1000000L};
+            nanosleep(&req, NULL);
+        }
+    }
+
+    restore_terminal();
+    clear_screen();
+    return EXIT_SUCCESS;
+}
+
+static int run_gui(struct life_state *life, int delay_ms) {
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        fprintf(stderr, "SDL_Init failed: %s\n", SDL_GetError());
+        return EXIT_FAILURE;
+    }
+
+    SDL_Window *window = SDL_CreateWindow("GameOfLifeGpt", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 1024, 768, SDL_WINDOW_RESIZABLE);
+    if (!window) {
+        fprintf(stderr, "SDL_CreateWindow failed: %s\n", SDL_GetError());
+        SDL_Quit();
+        return EXIT_FAILURE;
+    }
+
+    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    if (!renderer) {
+        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    }
+    if (!renderer) {
+        fprintf(stderr, "SDL_CreateRenderer failed: %s\n", SDL_GetError());
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+        return EXIT_FAILURE;
+    }
+
+    struct view_state view;
+    view_init(&view);
+
+    bool paused = false;
+    bool single_step = false;
+    size_t pending_steps = 0;
+    bool running = true;
+    bool dragging = false;
+    char info_message[128] = "Press q to quit, p to pause.";
+
+    while (running) {
+        SDL_Event event;
+        while (SDL_PollEvent(&event)) {
+            if (event.type == SDL_QUIT) {
+                running = false;
+            } else if (event.type == SDL_KEYDOWN) {
+                SDL_Keycode key = event.key.keysym.sym;
+                if (key == SDLK_q) {
+                    running = false;
+                } else if (key == SDLK_p) {
+                    paused = !paused;
+                } else if (key == SDLK_n) {
+                    single_step = true;
+                } else if (key == SDLK_w) {
+                    view_pan(&view, 0, -1);
+                } else if (key == SDLK_s) {
+                    view_pan(&view, 0, 1);
+                } else if (key == SDLK_a) {
+                    view_pan(&view, -1, 0);
+                } else if (key == SDLK_d) {
+                    view_pan(&view, 1, 0);
+                } else if (key == SDLK_PLUS || key == SDLK_EQUALS || key == SDLK_KP_PLUS) {
+                    view_zoom_in(&view);
+                } else if (key == SDLK_MINUS || key == SDLK_KP_MINUS) {
+                    view_zoom_out(&view);
+                } else if (key == SDLK_r) {
+                    view_init(&view);
+                    snprintf(info_message, sizeof(info_message), "View reset to origin");
+                } else if (key == SDLK_f) {
+                    int width = 0;
+                    int height = 0;
+                    SDL_GetWindowSize(window, &width, &height);
+                    view.follow = false;
+                    if (view_fit(&view, &life->census, MAX(1, width / BASE_TILE_PIXELS), MAX(1, height / BASE_TILE_PIXELS))) {
+                        snprintf(info_message, sizeof(info_message), "View fitted to live cells");
+                    }
+                } else if (key == SDLK_c) {
+                    view.follow = !view.follow;
+                    snprintf(info_message, sizeof(info_message), "Follow mode %s", view.follow ? "on" : "off");
+                }
+            } else if (event.type == SDL_MOUSEWHEEL) {
+                if (event.wheel.y > 0) {
+                    for (int i = 0; i < event.wheel.y; ++i) {
+                        view_zoom_in(&view);
+                    }
+                } else if (event.wheel.y < 0) {
+                    for (int i = 0; i < -event.wheel.y; ++i) {
+                        view_zoom_out(&view);
+                    }
+                }
+            } else if (event.type == SDL_MOUSEBUTTONDOWN) {
+                if (event.button.button == SDL_BUTTON_LEFT) {
+                    dragging = true;
+                }
+            } else if (event.type == SDL_MOUSEBUTTONUP) {
+                if (event.button.button == SDL_BUTTON_LEFT) {
+                    dragging = false;
+                }
+            } else if (event.type == SDL_MOUSEMOTION) {
+                if (dragging) {
+                    view.follow = false;
+                    view_pan_pixels(&view, -(double)event.motion.xrel, -(double)event.motion.yrel);
+                }
+            }
+        }
+
+        control_apply_commands(life->control, life, &paused, &pending_steps, info_message, sizeof(info_message));
+
+        if ((!paused) || single_step) {
+            life_state_advance(life, 1);
+            single_step = false;
+        } else if (pending_steps > 0) {
+            size_t chunk = MIN(pending_steps, (size_t)INTERACTIVE_STEP_CHUNK);
+            life_state_advance(life, chunk);
+            pending_steps -= chunk;
+        }
+        view_follow(&view, &life->census);
+        control_update_status(life->control, life, paused, NULL);
+
+        int width = 0;
+        int height = 0;
+        SDL_GetRendererOutputSize(renderer, &width, &height);
+        if (width <= 0 || height <= 0) {
+            SDL_GetWindowSize(window, &width, &height);
+        }
+        if (width <= 0) {
+            width = 1;
+        }
+        if (height <= 0) {
+            height = 1;
+        }
+        double render_start = monotonic_seconds();
+        render_state_sdl(renderer, life, &view, width, height);
+        latency_histogram_record(&life->stats.render_latency, monotonic_seconds() - render_start);
+        metrics_dump(life, paused, false);
+
+        char title[256];
+        char rule[48];
+        life_rule_format(&life->rule, rule, sizeof(rule));
+        snprintf(title, sizeof(title),
+                 "GameOfLifeGpt | Gen: %zu | Live: %zu (+%zu/-%zu) | Rule: %s | Speed: %d ms | Scale: %d | Center: (%d,%d) | %s",
+                 life->generation, life->census.population, life->census.births, life->census.deaths, rule, delay_ms, view.scale, view.center_x, view.center_y,
+                 paused ? "Paused" : "Running");
+        if (info_message[0]) {
+            size_t len = strlen(title);
+            if (len < sizeof(title)) {
+                snprintf(title + len, sizeof(title) - len, " | %s", info_message);
+            }
+        }
+        SDL_SetWindowTitle(window, title);
+        info_message[0] = '\0';
+
+        SDL_RenderPresent(renderer);
+
+        if (delay_ms > 0) {
+            SDL_Delay((Uint32)delay_ms);
+        }
+    }
+
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+    return EXIT_SUCCESS;
+}
+
+static int run_headless(struct life_state *life, size_t generations) {
+    if (life->scheduler) {
+        scheduler_reset_stats(life->scheduler);
+    }
+    bool chunked = life->publisher || life->control || life->metrics_path;
+    bool paused = false;
+    size_t pending_steps = 0;
+    size_t done = 0;
+    char info_message[128] = "";
+    int dtlb_fd = dtlb_counter_open();
+    double start = monotonic_seconds();
+    while (done < generations) {
+        control_apply_commands(life->control, life, &paused, &pending_steps, info_message, sizeof(info_message));
+        size_t limit = life->remove_escapees ? (size_t)ESCAPE_CHECK_INTERVAL : chunked ? (size_t)HEADLESS_CHUNK : generations;
+        size_t chunk = MIN(generations - done, limit);
+        if (paused) {
+            if (pending_steps == 0) {
+                struct timespec req = {0, 10000000L};
+                nanosleep(&req, NULL);
+                continue;
+            }
+            chunk = MIN(chunk, pending_steps);
+            pending_steps -= chunk;
+        }
+        life_state_advance(life, chunk);
+        control_update_status(life->control, life, paused, NULL);
+        metrics_dump(life, paused, false);
+        done += chunk;
+    }
+    metrics_dump(life, paused, true);
+    double elapsed = monotonic_seconds() - start;
+
+    const struct life_census *census = &life->census;
+    printf("Generation: %zu | Live cells: %zu | Elapsed: %.3f s | %.1f gen/s\n", life->generation, census->population, elapsed,
+           elapsed > 0.0 ? (double)generations / elapsed : 0.0);
+    printf("Births: %zu | Deaths: %zu | Bounds: (%d,%d)-(%d,%d)\n", census->births, census->deaths, census->min_x, census->min_y,
+           census->max_x, census->max_y);
+    if (life->remove_escapees) {
+        const uint64_t *escapees = life->stats.escapees;
+        printf("Escapees removed: %llu gliders | %llu LWSS | %llu MWSS | %llu HWSS\n", (unsigned long long)escapees[SHIP_GLIDER],
+               (unsigned long long)escapees[SHIP_LWSS], (unsigned long long)escapees[SHIP_MWSS],
+               (unsigned long long)escapees[SHIP_HWSS]);
+    }
+    const struct latency_histogram *hist = &life->stats.step_latency;
+    printf("Step latency: %llu samples | mean %.3f ms | p50 %.3f ms | p99 %.3f ms | p99.9 %.3f ms | max %.3f ms\n",
+           (unsigned long long)hist->total, hist->total ? hist->sum_seconds * 1e3 / (double)hist->total : 0.0,
+           latency_histogram_percentile(hist, 0.50) * 1e3, latency_histogram_percentile(hist, 0.99) * 1e3,
+           latency_histogram_percentile(hist, 0.999) * 1e3, hist->max_seconds * 1e3);
+    uint64_t dtlb_misses = 0;
+    char dtlb[48] = "n/a";
+    if (dtlb_counter_read(dtlb_fd, &dtlb_misses)) {
+        snprintf(dtlb, sizeof(dtlb), "%llu", (unsigned long long)dtlb_misses);
+    }
+    if (dtlb_fd >= 0) {
+        close(dtlb_fd);
+    }
+    printf("Pages: huge pages %s | %.1f MiB in mapped tables | %.1f MiB on huge pages | dTLB load misses (stepping thread) %s\n",
+           huge_pages_enabled ? "on" : "off",
+           (double)atomic_load_explicit(&huge_pages.mapped_bytes, memory_order_relaxed) / (1 << 20),
+           (double)process_huge_page_bytes() / (1 << 20), dtlb);
+    const struct tile_store *store = &life->tile_store;
+    uint64_t lookups = store->memo_hits + store->memo_misses;
+    if (lookups > 0) {
+        printf("Tile store: %zu interned tiles (peak %zu) | %llu tile steps | memo hit rate %.1f%% | %.1f MiB of %.1f MiB\n",
+               store->size, store->peak_size, (unsigned long long)lookups, 100.0 * (double)store->memo_hits / (double)lookups,
+               (double)tile_store_bytes(store) / (1 << 20), (double)store->budget / (1 << 20));
+        printf("Tile store GC: %llu collections | %.3f s | %.1f MiB reclaimed\n", (unsigned long long)store->collections,
+               store->collect_seconds, (double)store->reclaimed_bytes / (1 << 20));
+    }
+    const struct memo_cache *cache = store->cache;
+    if (cache) {
+        printf("Memo cache: %llu lookups | hit rate %.1f%% | %llu results added | %llu tiles, %llu results in %.1f MiB\n",
+               (unsigned long long)cache->lookups, cache->lookups ? 100.0 * (double)cache->hits / (double)cache->lookups : 0.0,
+               (unsigned long long)cache->added, (unsigned long long)cache->header->tile_count,
+               (unsigned long long)cache->header->entry_count, (double)cache->bytes / (1 << 20));
+    }
+    const struct cold_store *cold = &life->cold;
+    if (cold_store_enabled(cold)) {
+        printf("Cold store: %zu tiles (peak %zu) | %zu cells | %llu evictions | %llu faults | %.1f KiB %s | %zu cells in memory\n",
+               cold->size, cold->peak_size, cold_store_population(cold, life->generation), (unsigned long long)cold->evictions,
+               (unsigned long long)cold->fault_ins, (double)cold_store_bytes(cold) / 1024, cold->compressed ? "compressed" : "file",
+               cell_set_count(&life->live));
+    }
+    if (life->scheduler) {
+        scheduler_print_stats(life->scheduler, stdout);
+    }
+    return EXIT_SUCCESS;
+}
+
+enum dist_message_type {
+    DIST_ASSIGN = 1,
+    DIST_STEP,
+    DIST_REPORT,
+    DIST_COLLECT,
+    DIST_CELLS,
+    DIST_QUIT,
+};
+
+struct dist_message {
+    uint32_t type;
+    uint32_t count;
+    int32_t a;
+    int32_t b;
+    uint64_t generation;
+    /* The strip's census in DIST_REPORT. */
+    struct life_census census;
+};
+
+struct dist_buffer {
+    int32_t *coords;
+    size_t count;
+    size_t capacity;
+};
+
+static void dist_buffer_push(struct dist_buffer *buf, int x, int y) {
+    if (buf->count == buf->capacity) {
+        buf->capacity = buf->capacity ? buf->capacity * 2 : 256;
+        int32_t *grown = realloc(buf->coords, buf->capacity * 2 * sizeof(int32_t));
+        if (!grown) {
+            perror("realloc");
+            exit(EXIT_FAILURE);
+        }
+        buf->coords = grown;
+    }
+    buf->coords[2 * buf->count] = x;
+    buf->coords[2 * buf->count + 1] = y;
+    buf->count++;
+}
+
+static void write_all(int fd, const void *data, size_t size) {
+    const char *p = data;
+    while (size > 0) {
+        ssize_t written = write(fd, p, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("write");
+            exit(EXIT_FAILURE);
+        }
+        p += written;
+        size -= (size_t)written;
+    }
+}
+
+static void read_all(int fd, void *data, size_t size) {
+    char *p = data;
+    while (size > 0) {
+        ssize_t got = read(fd, p, size);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            fprintf(stderr, "distributed peer closed connection\n");
+            exit(EXIT_FAILURE);
+        }
+        p += got;
+        size -= (size_t)got;
+    }
+}
+
+static void dist_send(int fd, struct dist_message msg, const int32_t *coords) {
+    write_all(fd, &msg, sizeof(msg));
+    if (msg.count > 0) {
+        write_all(fd, coords, (size_t)msg.count * 2 * sizeof(int32_t));
+    }
+}
+
+static struct dist_message dist_receive(int fd, struct dist_buffer *buf) {
+    struct dist_message msg;
+    read_all(fd, &msg, sizeof(msg));
+    buf->count = 0;
+    for (uint32_t i = 0; i < msg.count; ++i) {
+        dist_buffer_push(buf, 0, 0);
+    }
+    if (msg.count > 0) {
+        read_all(fd, buf->coords, (size_t)msg.count * 2 * sizeof(int32_t));
+    }
+    return msg;
+}
+
+/* Drops the cells outside the strip and takes them out of the census the
+   step left behind: outside cells that were not halo cells were born there,
+   and halo cells that are gone died there. The bounds are those of the strip
+   cells seen by the same pass. */
+static struct dist_message dist_worker_report(struct life_state *life, int x_lo, int x_hi, const struct cell_set *ghosts,
+                                              struct dist_buffer *border) {
+    struct dist_buffer outside = {0};
+    struct dist_buffer right = {0};
+    struct life_census *census = &life->census;
+    struct life_census strip;
+    life_census_reset(&strip);
+    border->count = 0;
+    struct cell_iterator it = cell_set_iter(&life->live);
+    int x, y;
+    while (cell_iter_next(&it, &x, &y)) {
+        if (x < x_lo || x >= x_hi) {
+            dist_buffer_push(&outside, x, y);
+            census->population--;
+            census->sum_x -= x;
+            census->sum_y -= y;
+            if (!cell_set_contains(ghosts, x, y)) {
+                census->births--;
+                census->change_sum_x -= x;
+                census->change_sum_y -= y;
+            }
+        } else {
+            life_census_add(&strip, x, y);
+            if (x == x_lo) {
+                dist_buffer_push(border, x, y);
+            }
+            if (x == x_hi - 1) {
+                dist_buffer_push(&right, x, y);
+            }
+        }
+    }
+    it = cell_set_iter(ghosts);
+    while (cell_iter_next(&it, &x, &y)) {
+        if (!cell_set_contains(&life->live, x, y)) {
+            census->deaths--;
+            census->change_sum_x -= x;
+            census->change_sum_y -= y;
+        }
+    }
+    for (size_t i = 0; i < outside.count; ++i) {
+        cell_set_remove(&life->live, outside.coords[2 * i], outside.coords[2 * i + 1]);
+    }
+    census->min_x = strip.min_x;
+    census->min_y = strip.min_y;
+    census->max_x = strip.max_x;
+    census->max_y = strip.max_y;
+    struct dist_message msg = {DIST_REPORT, 0, (int32_t)border->count, 0, life->generation, *census};
+    for (size_t i = 0; i < right.count; ++i) {
+        dist_buffer_push(border, right.coords[2 * i], right.coords[2 * i + 1]);
+    }
+    msg.count = (uint32_t)border->count;
+    free(outside.coords);
+    free(right.coords);
+    return msg;
+}
+
+static void dist_worker_main(int fd, const struct life_rule *rule, size_t tile_budget) {
+    struct life_state life;
+    life_state_init(&life);
+    life.rule = *rule;
+    life.tile_store.budget = tile_budget;
+    struct dist_buffer in = {0};
+    struct dist_buffer border = {0};
+    struct cell_set ghosts;
+    cell_set_init(&ghosts, 256);
+    int x_lo = 0;
+    int x_hi = 0;
+
+    for (;;) {
+        struct dist_message msg = dist_receive(fd, &in);
+        if (msg.type == DIST_QUIT) {
+            break;
+        }
+        if (msg.type == DIST_COLLECT) {
+            struct dist_buffer all = {0};
+            struct cell_iterator it = cell_set_iter(&life.live);
+            int x, y;
+            while (cell_iter_next(&it, &x, &y)) {
+                dist_buffer_push(&all, x, y);
+            }
+            struct dist_message reply = {.type = DIST_CELLS, .count = (uint32_t)all.count, .generation = life.generation};
+            dist_send(fd, reply, all.coords);
+            free(all.coords);
+            life_state_clear(&life);
+            continue;
+        }
+        if (msg.type == DIST_ASSIGN) {
+            life_state_clear(&life);
+            x_lo = msg.a;
+            x_hi = msg.b;
+            life.generation = (size_t)msg.generation;
+        }
+        /* Assigned cells join the strip. Halo cells only feed this step, so
+           they are remembered and dropped again by the report. */
+        cell_set_clear(&ghosts);
+        for (size_t i = 0; i < in.count; ++i) {
+            int x = in.coords[2 * i];
+            int y = in.coords[2 * i + 1];
+            if (cell_set_contains(&life.live, x, y)) {
+                continue;
+            }
+            cell_set_insert(&life.live, x, y);
+            life_census_add(&life.census, x, y);
+            if (msg.type == DIST_STEP) {
+                cell_set_insert(&ghosts, x, y);
+            }
+        }
+        tile_phase_map_reset(&life.phases);
+        if (msg.type == DIST_STEP) {
+            life_state_step(&life);
+        }
+        struct dist_message reply = dist_worker_report(&life, x_lo, x_hi, &ghosts, &border);
+        dist_send(fd, reply, border.coords);
+    }
+
+    free(in.coords);
+    free(border.coords);
+    cell_set_destroy(&ghosts);
+    life_state_destroy(&life);
+}
+
+struct dist_worker {
+    pid_t pid;
+    int fd;
+    int x_lo;
+    int x_hi;
+    struct life_census census;
+    struct dist_buffer border;
+    size_t left_count;
+};
+
+static int compare_int(const void *a, const void *b) {
+    int ia = *(const int *)a;
+    int ib = *(const int *)b;
+    return ia < ib ? -1 : ia > ib;
+}
+
+static void dist_assign(struct dist_worker *workers, int count, struct dist_buffer *cells, size_t generation) {
+    int *xs = malloc(MAX(cells->count, (size_t)1) * sizeof(int));
+    if (!xs) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < cells->count; ++i) {
+        xs[i] = cells->coords[2 * i];
+    }
+    qsort(xs, cells->count, sizeof(int), compare_int);
+
+    /* Strip boundaries sit at population quantiles of x, so every process
+       starts with a similar share of live cells. */
+    int previous = INT_MIN;
+    for (int w = 0; w < count; ++w) {
+        workers[w].x_lo = previous;
+        if (w == count - 1) {
+            workers[w].x_hi = INT_MAX;
+        } else {
+            int split = cells->count > 0 ? xs[cells->count * (size_t)(w + 1) / (size_t)count] : w + 1 - count / 2;
+            workers[w].x_hi = MAX(split, previous == INT_MIN ? split : previous + 1);
+        }
+        previous = workers[w].x_hi;
+    }
+    free(xs);
+
+    struct dist_buffer *parts = calloc((size_t)count, sizeof(struct dist_buffer));
+    if (!parts) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < cells->count; ++i) {
+        int x = cells->coords[2 * i];
+        int w = 0;
+        while (x >= workers[w].x_hi) {
+            w++;
+        }
+        dist_buffer_push(&parts[w], x, cells->coords[2 * i + 1]);
+    }
+    for (int w = 0; w < count; ++w) {
+        struct dist_message msg = {.type = DIST_ASSIGN, .count = (uint32_t)parts[w].count, .a = workers[w].x_lo, .b = workers[w].x_hi,
+                                   .generation = generation};
+        dist_send(workers[w].fd, msg, parts[w].coords);
+        free(parts[w].coords);
+    }
+    free(parts);
+}
+
+static void dist_collect_reports(struct dist_worker *workers, int count, size_t generation) {
+    for (int w = 0; w < count; ++w) {
+        struct dist_message msg = dist_receive(workers[w].fd, &workers[w].border);
+        if (msg.type != DIST_REPORT || msg.generation != generation) {
+            fprintf(stderr, "worker %d out of lockstep (generation %llu, expected %zu)\n", w, (unsigned long long)msg.generation,
+                    generation);
+            exit(EXIT_FAILURE);
+        }
+        workers[w].census = msg.census;
+        workers[w].left_count = (size_t)msg.a;
+    }
+}
+
+static void dist_gather(struct dist_worker *workers, int count, struct dist_buffer *cells) {
+    struct dist_message collect = {.type = DIST_COLLECT};
+    for (int w = 0; w < count; ++w) {
+        dist_send(workers[w].fd, collect, NULL);
+    }
+    cells->count = 0;
+    struct dist_buffer part = {0};
+    for (int w = 0; w < count; ++w) {
+        dist_receive(workers[w].fd, &part);
+        for (size_t i = 0; i < part.count; ++i) {
+            dist_buffer_push(cells, part.coords[2 * i], part.coords[2 * i + 1]);
+        }
+    }
+    free(part.coords);
+}
+
+static int run_distributed(struct life_state *life, size_t generations, int worker_count) {
+    struct dist_worker *workers = calloc((size_t)worker_count, sizeof(struct dist_worker));
+    if (!workers) {
+        perror("calloc");
+        return EXIT_FAILURE;
+    }
+    fflush(stdout);
+    for (int w = 0; w < worker_count; ++w) {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1) {
+            perror("socketpair");
+            return EXIT_FAILURE;
+        }
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("fork");
+            return EXIT_FAILURE;
+        }
+        if (pid == 0) {
+            close(fds[0]);
+            for (int i = 0; i < w; ++i) {
+                close(workers[i].fd);
+            }
+            dist_worker_main(fds[1], &life->rule, life->tile_store.budget);
+            _exit(EXIT_SUCCESS);
+        }
+        close(fds[1]);
+        workers[w].pid = pid;
+        workers[w].fd = fds[0];
+    }
+
+    struct dist_buffer cells = {0};
+    struct cell_iterator it = cell_set_iter(&life->live);
+    int x, y;
+    while (cell_iter_next(&it, &x, &y)) {
+        dist_buffer_push(&cells, x, y);
+    }
+
+    double start = monotonic_seconds();
+    size_t generation = life->generation;
+    int rebalances = 0;
+    dist_assign(workers, worker_count, &cells, generation);
+    dist_collect_reports(workers, worker_count, generation);
+
+    struct dist_buffer halo = {0};
+    for (size_t step = 0; step < generations; ++step) {
+        for (int w = 0; w < worker_count; ++w) {
+            halo.count = 0;
+            if (w > 0) {
+                const struct dist_worker *left = &workers[w - 1];
+                for (size_t i = left->left_count; i < left->border.count; ++i) {
+                    dist_buffer_push(&halo, left->border.coords[2 * i], left->border.coords[2 * i + 1]);
+                }
+            }
+            if (w + 1 < worker_count) {
+                const struct dist_worker *right = &workers[w + 1];
+                for (size_t i = 0; i < right->left_count; ++i) {
+                    dist_buffer_push(&halo, right->border.coords[2 * i], right->border.coords[2 * i + 1]);
+                }
+            }
+            struct dist_message msg = {.type = DIST_STEP, .count = (uint32_t)halo.count, .generation = generation};
+            dist_send(workers[w].fd, msg, halo.coords);
+        }
+        generation++;
+        dist_collect_reports(workers, worker_count, generation);
+        life_census_reset(&life->census);
+        for (int w = 0; w < worker_count; ++w) {
+            life_census_merge(&life->census, &workers[w].census);
+        }
+
+        if (generation % DIST_REBALANCE_INTERVAL == 0) {
+            size_t total = 0;
+            size_t largest = 0;
+            for (int w = 0; w < worker_count; ++w) {
+                total += workers[w].census.population;
+                largest = MAX(largest, workers[w].census.population);
+            }
+            if (total >= (size_t)worker_count * 64 && largest * (size_t)worker_count > total * 3 / 2) {
+                dist_gather(workers, worker_count, &cells);
+                dist_assign(workers, worker_count, &cells, generation);
+                dist_collect_reports(workers, worker_count, generation);
+                rebalances++;
+            }
+        }
+    }
+    double elapsed = monotonic_seconds() - start;
+
+    dist_gather(workers, worker_count, &cells);
+    cell_set_clear(&life->live);
+    for (size_t i = 0; i < cells.count; ++i) {
+        cell_set_insert(&life->live, cells.coords[2 * i], cells.coords[2 * i + 1]);
+    }
+    tile_phase_map_reset(&life->phases);
+    life->generation = generation;
+
+    printf("Generation: %zu | Live cells: %zu | Elapsed: %.3f s | %.1f gen/s | Rebalances: %d\n", life->generation,
+           cell_set_count(&life->live), elapsed, elapsed > 0.0 ? (double)generations / elapsed : 0.0, rebalances);
+    printf("Births: %zu | Deaths: %zu | Bounds: (%d,%d)-(%d,%d)\n", life->census.births, life->census.deaths, life->census.min_x,
+           life->census.min_y, life->census.max_x, life->census.max_y);
+    struct dist_message quit = {.type = DIST_QUIT};
+    for (int w = 0; w < worker_count; ++w) {
+        printf("Process %d: pid %d | columns [%d, %d) | live cells %zu\n", w, (int)workers[w].pid, workers[w].x_lo, workers[w].x_hi,
+               workers[w].census.population);
+        dist_send(workers[w].fd, quit, NULL);
+        close(workers[w].fd);
+        waitpid(workers[w].pid, NULL, 0);
+        free(workers[w].border.coords);
+    }
+    free(workers);
+    free(cells.coords);
+    free(halo.coords);
+    return EXIT_SUCCESS;
+}
+
+/* Soup searches run many small, independent universes. A soup batch packs up
+   to 64 of them into the bit lanes of one word per cell position, so each
+   bitwise operation of the kernel advances every soup at once. The field is
+   bounded: the union bounding box of the batch plus SOUP_MARGIN cells on each
+   side, surrounded by a ring of permanently dead cells. Gliders and *WSS that
+   reach the ring are removed and counted, as --remove-escapees does. Anything
+   else that reaches it grows the field by SOUP_MARGIN on every side, up to
+   SOUP_MAX_FIELD cells across; past that, the soup leaves the batch and is
+   finished on the general stepper. */
+#define SOUP_LANES 64
+#define SOUP_MARGIN 48
+#define SOUP_MAX_FIELD 512
+#define SOUP_DEFAULT_GENERATIONS 4000
+#define SOUP_MAX_PERIOD 30
+#define SOUP_CHECK_INTERVAL 8
+
+struct soup_result {
+    size_t generations;
+    size_t period;
+    size_t population;
+    /* Spaceships removed at the field edge, by kind. */
+    uint64_t escapees[SHIP_KINDS];
+    bool unbatched;
+};
+
+/* Every history buffer remembers the bounding box of its non-zero words
+   (empty when x0 > x1), so the kernel and the comparisons only sweep the
+   region the batch actually occupies. */
+struct soup_box {
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+};
+
+struct soup_field {
+    int width;
+    int height;
+    int origin_x;
+    int origin_y;
+    uint64_t *history[SOUP_MAX_PERIOD + 1];
+    struct soup_box boxes[SOUP_MAX_PERIOD + 1];
+};
+
+static struct soup_box soup_box_union(struct soup_box a, struct soup_box b) {
+    if (a.x0 > a.x1) {
+        return b;
+    }
+    if (b.x0 > b.x1) {
+        return a;
+    }
+    struct soup_box box = {MIN(a.x0, b.x0), MIN(a.y0, b.y0), MAX(a.x1, b.x1), MAX(a.y1, b.y1)};
+    return box;
+}
+
+/* Steps buffer `from` into buffer `to`. The swept region covers the source
+   box grown by one cell plus whatever `to` held before, so stale cells from
+   older generations are overwritten (with zeros, as B0 is never allowed). */
+static void soup_field_step(struct soup_field *field, int from, int to, const struct life_rule *rule) {
+    int w = field->width;
+    const uint64_t *src = field->history[from];
+    uint64_t *dst = field->history[to];
+    struct soup_box grown = field->boxes[from];
+    if (grown.x0 <= grown.x1) {
+        grown.x0 = MAX(1, grown.x0 - 1);
+        grown.y0 = MAX(1, grown.y0 - 1);
+        grown.x1 = MIN(w - 2, grown.x1 + 1);
+        grown.y1 = MIN(field->height - 2, grown.y1 + 1);
+    }
+    struct soup_box sweep = soup_box_union(grown, field->boxes[to]);
+    struct soup_box live = {INT_MAX, INT_MAX, INT_MIN, INT_MIN};
+    bool conway = life_rule_is_conway(rule);
+    for (int y = sweep.y0; y <= sweep.y1; ++y) {
+        const uint64_t *up = src + (size_t)(y - 1) * w;
+        const uint64_t *mid = src + (size_t)y * w;
+        const uint64_t *down = src + (size_t)(y + 1) * w;
+        uint64_t *out = dst + (size_t)y * w;
+        uint64_t row_any = 0;
+        for (int x = sweep.x0; x <= sweep.x1; ++x) {
+            uint64_t ones, twos, fours, eights;
+            if (rule->neighbourhood == NEIGHBOURHOOD_MOORE) {
+                uint64_t s_a, c_a, s_b, c_b, c_d, t, u;
+                full_add(up[x - 1], up[x], up[x + 1], &s_a, &c_a);
+                full_add(mid[x - 1], mid[x + 1], down[x - 1], &s_b, &c_b);
+                uint64_t s_c = down[x] ^ down[x + 1];
+                uint64_t c_c = down[x] & down[x + 1];
+                full_add(s_a, s_b, s_c, &ones, &c_d);
+                full_add(c_a, c_b, c_c, &t, &u);
+                twos = t ^ c_d;
+                uint64_t k = t & c_d;
+                if (conway) {
+                    out[x] = twos & ~(u | k) & (ones | mid[x]);
+                    row_any |= out[x];
+                    continue;
+                }
+                fours = u ^ k;
+                eights = u & k;
+            } else {
+                uint64_t c_a, c_b;
+                uint64_t east_west = mid[x - 1] ^ mid[x + 1];
+                full_add(up[x], down[x], east_west, &ones, &c_a);
+                c_b = mid[x - 1] & mid[x + 1];
+                if (rule->neighbourhood == NEIGHBOURHOOD_HEXAGONAL) {
+                    uint64_t s_d, c_d;
+                    full_add(ones, up[x - 1], down[x + 1], &s_d, &c_d);
+                    ones = s_d;
+                    full_add(c_a, c_b, c_d, &twos, &fours);
+                } else {
+                    twos = c_a ^ c_b;
+                    fours = c_a & c_b;
+                }
+                eights = 0;
+            }
+            out[x] = life_rule_apply(rule, ones, twos, fours, eights, mid[x]);
+            row_any |= out[x];
+        }
+        if (row_any) {
+            int first = sweep.x0;
+            int last = sweep.x1;
+            while (out[first] == 0) {
+                first++;
+            }
+            while (out[last] == 0) {
+                last--;
+            }
+            live.x0 = MIN(live.x0, first);
+            live.x1 = MAX(live.x1, last);
+            live.y0 = MIN(live.y0, y);
+            live.y1 = MAX(live.y1, y);
+        }
+    }
+    field->boxes[to] = live;
+}
+
+static void soup_field_extract(const struct soup_field *field, int index, int lane, struct cell_set *out) {
+    cell_set_clear(out);
+    const uint64_t *cells = field->history[index];
+    const struct soup_box *box = &field->boxes[index];
+    uint64_t bit = (uint64_t)1 << lane;
+    for (int y = box->y0; y <= box->y1; ++y) {
+        for (int x = box->x0; x <= box->x1; ++x) {
+            if (cells[(size_t)y * field->width + x] & bit) {
+                cell_set_insert(out, field->origin_x + x, field->origin_y + y);
+            }
+        }
+    }
+}
+
+/* Lanes whose state equals the one `p` generations back have stabilised with
+   period p; each lane reports the smallest such p. A comparison stops as soon
+   as every lane still in question has differed. */
+static uint64_t soup_field_settled(const struct soup_field *field, size_t generation, uint64_t lanes, size_t *periods) {
+    int now_index = (int)(generation % (SOUP_MAX_PERIOD + 1));
+    const uint64_t *now = field->history[now_index];
+    uint64_t settled = 0;
+    for (size_t p = 1; p <= SOUP_MAX_PERIOD && p <= generation; ++p) {
+        int then_index = (int)((generation - p) % (SOUP_MAX_PERIOD + 1));
+        const uint64_t *then = field->history[then_index];
+        struct soup_box box = soup_box_union(field->boxes[now_index], field->boxes[then_index]);
+        uint64_t pending = lanes & ~settled;
+        uint64_t differ = 0;
+        for (int y = box.y0; y <= box.y1 && (differ & pending) != pending; ++y) {
+            for (int x = box.x0; x <= box.x1; ++x) {
+                size_t i = (size_t)y * field->width + x;
+                differ |= now[i] ^ then[i];
+            }
+        }
+        uint64_t fresh = pending & ~differ;
+        for (uint64_t bits = fresh; bits; bits &= bits - 1) {
+            periods[__builtin_ctzll(bits)] = p;
+        }
+        settled |= fresh;
+    }
+    return settled;
+}
+
+/* Lanes with live cells next to the dead ring would be cut short there by
+   the next step. */
+static uint64_t soup_field_edge(const struct soup_field *field, int index) {
+    const uint64_t *cells = field->history[index];
+    const struct soup_box *box = &field->boxes[index];
+    int w = field->width;
+    int h = field->height;
+    uint64_t edge = 0;
+    if (box->x0 > box->x1 || (box->x0 > 1 && box->y0 > 1 && box->x1 < w - 2 && box->y1 < h - 2)) {
+        return 0;
+    }
+    for (int x = 1; x + 1 < w; ++x) {
+        edge |= cells[(size_t)w + x] | cells[(size_t)(h - 2) * w + x];
+    }
+    for (int y = 1; y + 1 < h; ++y) {
+        edge |= cells[(size_t)y * w + 1] | cells[(size_t)y * w + w - 2];
+    }
+    return edge;
+}
+
+/* Removes the escaping spaceships of `lane` from buffer `index` and counts
+   them in `result`. Fails, leaving the buffer alone, when the lane would
+   still touch the dead ring without them. */
+static bool soup_field_release(struct soup_field *field, int index, int lane, const struct life_rule *rule,
+                               struct soup_result *result) {
+    if (!life_rule_is_conway(rule)) {
+        return false;
+    }
+    struct life_state state;
+    life_state_init(&state);
+    soup_field_extract(field, index, lane, &state.live);
+    life_state_recount(&state);
+    life_state_remove_escapees(&state);
+    const struct life_census *census = &state.census;
+    bool inside = census->population == 0 ||
+                  (census->min_x - field->origin_x > 1 && census->min_y - field->origin_y > 1 &&
+                   census->max_x - field->origin_x < field->width - 2 && census->max_y - field->origin_y < field->height - 2);
+    if (inside) {
+        uint64_t *cells = field->history[index];
+        const struct soup_box *box = &field->boxes[index];
+        uint64_t bit = (uint64_t)1 << lane;
+        for (int y = box->y0; y <= box->y1; ++y) {
+            for (int x = box->x0; x <= box->x1; ++x) {
+                cells[(size_t)y * field->width + x] &= ~bit;
+            }
+        }
+        struct cell_iterator it = cell_set_iter(&state.live);
+        int x, y;
+        while (cell_iter_next(&it, &x, &y)) {
+            cells[(size_t)(y - field->origin_y) * field->width + (x - field->origin_x)] |= bit;
+        }
+        for (int kind = 0; kind < SHIP_KINDS; ++kind) {
+            result->escapees[kind] += state.stats.escapees[kind];
+        }
+    }
+    life_state_destroy(&state);
+    return inside;
+}
+
+/* Widens the field by SOUP_MARGIN on every side, leaving every buffer's cells
+   at the same plane coordinates. */
+static bool soup_field_grow(struct soup_field *field) {
+    int width = field->width + 2 * SOUP_MARGIN;
+    int height = field->height + 2 * SOUP_MARGIN;
+    if (MAX(width, height) > SOUP_MAX_FIELD) {
+        return false;
+    }
+    for (int i = 0; i <= SOUP_MAX_PERIOD; ++i) {
+        uint64_t *cells = calloc((size_t)width * height, sizeof(*cells));
+        if (!cells) {
+            perror("calloc");
+            exit(EXIT_FAILURE);
+        }
+        struct soup_box *box = &field->boxes[i];
+        if (box->x0 <= box->x1) {
+            for (int y = box->y0; y <= box->y1; ++y) {
+                memcpy(cells + (size_t)(y + SOUP_MARGIN) * width + box->x0 + SOUP_MARGIN,
+                       field->history[i] + (size_t)y * field->width + box->x0, (size_t)(box->x1 - box->x0 + 1) * sizeof(*cells));
+            }
+            box->x0 += SOUP_MARGIN;
+            box->y0 += SOUP_MARGIN;
+            box->x1 += SOUP_MARGIN;
+            box->y1 += SOUP_MARGIN;
+        }
+        free(field->history[i]);
+        field->history[i] = cells;
+    }
+    counter_add(&counters.allocations, SOUP_MAX_PERIOD + 1);
+    field->width = width;
+    field->height = height;
+    field->origin_x -= SOUP_MARGIN;
+    field->origin_y -= SOUP_MARGIN;
+    return true;
+}
+
+/* Removes `lanes` from the newest buffer so they no longer widen its box. */
+static void soup_field_drop(struct soup_field *field, int index, uint64_t lanes) {
+    uint64_t *cells = field->history[index];
+    const struct soup_box *box = &field->boxes[index];
+    for (int y = box->y0; y <= box->y1; ++y) {
+        for (int x = box->x0; x <= box->x1; ++x) {
+            cells[(size_t)y * field->width + x] &= ~lanes;
+        }
+    }
+}
+
+static void soup_copy_cells(struct cell_set *dst, const struct cell_set *src) {
+    cell_set_clear(dst);
+    struct cell_iterator it = cell_set_iter(src);
+    int x, y;
+    while (cell_iter_next(&it, &x, &y)) {
+        cell_set_insert(dst, x, y);
+    }
+}
+
+static bool soup_cells_equal(const struct cell_set *a, const struct cell_set *b) {
+    if (cell_set_count(a) != cell_set_count(b)) {
+        return false;
+    }
+    struct cell_iterator it = cell_set_iter(a);
+    int x, y;
+    while (cell_iter_next(&it, &x, &y)) {
+        if (!cell_set_contains(b, x, y)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Finishes lane `lane` of the batch on the general stepper, starting from the
+   newest buffer at `generation`. The lane's history in the field seeds the
+   settling check, so the soup settles at the same generation it would have
+   in an unbounded batch. */
+static void soup_finish_single(const struct soup_field *field, int lane, size_t generation, const struct life_rule *rule,
+                               size_t max_generations, struct cell_set *soup, struct soup_result *result) {
+    struct cell_set history[SOUP_MAX_PERIOD + 1];
+    for (int k = 0; k <= SOUP_MAX_PERIOD; ++k) {
+        cell_set_init(&history[k], 64);
+    }
+    for (size_t k = 0; k <= SOUP_MAX_PERIOD && k <= generation; ++k) {
+        int index = (int)((generation - k) % (SOUP_MAX_PERIOD + 1));
+        soup_field_extract(field, index, lane, &history[index]);
+    }
+    struct life_state state;
+    life_state_init(&state);
+    state.rule = *rule;
+    soup_copy_cells(&state.live, &history[generation % (SOUP_MAX_PERIOD + 1)]);
+    life_state_recount(&state);
+
+    size_t period = 0;
+    while (generation < max_generations) {
+        life_state_step(&state);
+        generation++;
+        struct cell_set *now = &history[generation % (SOUP_MAX_PERIOD + 1)];
+        soup_copy_cells(now, &state.live);
+        if (generation % SOUP_CHECK_INTERVAL != 0 || generation == max_generations) {
+            continue;
+        }
+        for (size_t p = 1; p <= SOUP_MAX_PERIOD && p <= generation && !period; ++p) {
+            if (soup_cells_equal(now, &history[(generation - p) % (SOUP_MAX_PERIOD + 1)])) {
+                period = p;
+            }
+        }
+        if (period) {
+            break;
+        }
+    }
+    soup_copy_cells(soup, &state.live);
+    result->generations = generation;
+    result->period = period;
+    result->population = cell_set_count(soup);
+    result->unbatched = true;
+    life_state_destroy(&state);
+    for (int k = 0; k <= SOUP_MAX_PERIOD; ++k) {
+        cell_set_destroy(&history[k]);
+    }
+}
+
+static void soup_batch_run_lanes(struct cell_set *soups, struct soup_result *results, int count, const struct life_rule *rule,
+                                 size_t max_generations) {
+    int min_x = INT_MAX, min_y = INT_MAX, max_x = INT_MIN, max_y = INT_MIN;
+    for (int s = 0; s < count; ++s) {
+        struct cell_iterator it = cell_set_iter(&soups[s]);
+        int x, y;
+        while (cell_iter_next(&it, &x, &y)) {
+            min_x = MIN(min_x, x);
+            max_x = MAX(max_x, x);
+            min_y = MIN(min_y, y);
+            max_y = MAX(max_y, y);
+        }
+    }
+    if (min_x > max_x) {
+        min_x = max_x = min_y = max_y = 0;
+    }
+
+    struct soup_field field;
+    field.origin_x = min_x - SOUP_MARGIN - 1;
+    field.origin_y = min_y - SOUP_MARGIN - 1;
+    field.width = max_x - min_x + 1 + 2 * (SOUP_MARGIN + 1);
+    field.height = max_y - min_y + 1 + 2 * (SOUP_MARGIN + 1);
+    size_t cells = (size_t)field.width * field.height;
+    for (int i = 0; i <= SOUP_MAX_PERIOD; ++i) {
+        field.history[i] = calloc(cells, sizeof(uint64_t));
+        if (!field.history[i]) {
+            perror("calloc");
+            exit(EXIT_FAILURE);
+        }
+        field.boxes[i] = (struct soup_box){1, 1, 0, 0};
+    }
+    counter_add(&counters.allocations, SOUP_MAX_PERIOD + 1);
+
+    for (int s = 0; s < count; ++s) {
+        struct cell_iterator it = cell_set_iter(&soups[s]);
+        int x, y;
+        while (cell_iter_next(&it, &x, &y)) {
+            field.history[0][(size_t)(y - field.origin_y) * field.width + (x - field.origin_x)] |= (uint64_t)1 << s;
+        }
+    }
+    if (count > 0) {
+        field.boxes[0] = (struct soup_box){min_x - field.origin_x, min_y - field.origin_y, max_x - field.origin_x, max_y - field.origin_y};
+    }
+
+    memset(results, 0, (size_t)count * sizeof(*results));
+    uint64_t running = count == SOUP_LANES ? ~(uint64_t)0 : (((uint64_t)1 << count) - 1);
+    size_t periods[SOUP_LANES] = {0};
+    size_t generation = 0;
+    while (running && generation < max_generations) {
+        int from = (int)(generation % (SOUP_MAX_PERIOD + 1));
+        int to = (int)((generation + 1) % (SOUP_MAX_PERIOD + 1));
+        soup_field_step(&field, from, to, rule);
+        generation++;
+        counter_add(&counters.cells_updated, (uint64_t)count * (uint64_t)((field.boxes[to].x1 - field.boxes[to].x0 + 1) *
+                                                                         (field.boxes[to].y1 - field.boxes[to].y0 + 1)));
+        /* Checked every generation: the state in `to` is still exact, the next
+           one would not be. */
+        uint64_t edge = generation < max_generations ? soup_field_edge(&field, to) & running : 0;
+        uint64_t blocked = 0;
+        for (uint64_t bits = edge; bits; bits &= bits - 1) {
+            int lane = __builtin_ctzll(bits);
+            if (!soup_field_release(&field, to, lane, rule, &results[lane])) {
+                blocked |= (uint64_t)1 << lane;
+            }
+        }
+        uint64_t leaving = blocked && !soup_field_grow(&field) ? blocked : 0;
+        for (uint64_t bits = leaving; bits; bits &= bits - 1) {
+            int lane = __builtin_ctzll(bits);
+            soup_finish_single(&field, lane, generation, rule, max_generations, &soups[lane], &results[lane]);
+        }
+        if (leaving) {
+            soup_field_drop(&field, to, leaving);
+            running &= ~leaving;
+        }
+        if (generation % SOUP_CHECK_INTERVAL != 0 && generation < max_generations) {
+            continue;
+        }
+        uint64_t done = generation < max_generations ? soup_field_settled(&field, generation, running, periods) : running;
+        for (uint64_t bits = done; bits; bits &= bits - 1) {
+            int lane = __builtin_ctzll(bits);
+            soup_field_extract(&field, to, lane, &soups[lane]);
+            results[lane].generations = generation;
+            results[lane].period = periods[lane];
+            results[lane].population = cell_set_count(&soups[lane]);
+        }
+        if (done) {
+            soup_field_drop(&field, to, done);
+        }
+        running &= ~done;
+    }
+    for (int i = 0; i <= SOUP_MAX_PERIOD; ++i) {
+        free(field.history[i]);
+    }
+}
+
+/* Advances every soup until it settles into a still life or an oscillator of
+   period at most SOUP_MAX_PERIOD, or for `max_generations`, whichever comes
+   first, and replaces soups[i] with that final state. Settling is checked
+   every SOUP_CHECK_INTERVAL generations. Spaceships that fly off the field
+   are missing from the final state and counted in the result's `escapees`.
+   Results flagged `unbatched` reached the edge with something else and were
+   finished one at a time on the general stepper, so they are exact but cost
+   as much as an unbatched soup. Larger than Life rules are not supported and
+   make the call return false. */
+static bool soup_batch_run(struct cell_set *soups, struct soup_result *results, size_t count, const struct life_rule *rule,
+                           size_t max_generations) {
+    if (life_rule_is_ltl(rule)) {
+        return false;
+    }
+    for (size_t base = 0; base < count; base += SOUP_LANES) {
+        int lanes = (int)MIN((size_t)SOUP_LANES, count - base);
+        soup_batch_run_lanes(soups + base, results + base, lanes, rule, max_generations);
+    }
+    return true;
+}
+
+/* Reads soups in the pattern file format, one after another, separated by
+   blank lines. Returns -1 with errno set if the file cannot be opened. */
+static int soup_read_file(const char *path, struct cell_set **out, size_t *out_count) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        return -1;
+    }
+    struct cell_set *soups = NULL;
+    size_t count = 0, capacity = 0;
+    bool in_soup = false;
+    char *line = NULL;
+    size_t len = 0;
+    ssize_t read;
+    int y = 0;
+    while ((read = getline(&line, &len, fp)) != -1) {
+        if (read > 0 && (line[0] == '!' || line[0] == '#')) {
+            continue;
+        }
+        size_t end = strcspn(line, "\r\n");
+        if (end == 0) {
+            in_soup = false;
+            continue;
+        }
+        if (!in_soup) {
+            if (count == capacity) {
+                capacity = capacity ? capacity * 2 : 64;
+                soups = realloc(soups, capacity * sizeof(*soups));
+                if (!soups) {
+                    perror("realloc");
+                    exit(EXIT_FAILURE);
+                }
             }
+            cell_set_init(&soups[count++], 256);
+            in_soup = true;
+            y = 0;
         }
-
-        if (bytes == -1 && errno != EAGAIN && errno != EWOULDBLOCK) {
-            perror("read");
-            running = false;
-            break;
+        for (size_t x = 0; x < end; ++x) {
+            char c = line[x];
+            if (c == 'O' || c == 'o' || c == 'X' || c == '1') {
+                cell_set_insert(&soups[count - 1], (int)x, y);
+            }
         }
+        y += 1;
+    }
+    free(line);
+    fclose(fp);
+    *out = soups;
+    *out_count = count;
+    return 0;
+}
 
-        if ((!paused) || single_step) {
-            life_state_step(life);
-            single_step = false;
+/* Runs every soup in `path` through the soup batch and prints each final
+   state as a pattern under a comment line with its result, so the output
+   can be read back as a soup file. */
+static int run_soups(const char *path, const struct life_rule *rule, size_t max_generations) {
+    if (life_rule_is_ltl(rule)) {
+        fprintf(stderr, "--soups only supports range-1 B/S rules\n");
+        return EXIT_FAILURE;
+    }
+    struct cell_set *soups = NULL;
+    size_t count = 0;
+    if (soup_read_file(path, &soups, &count) == -1) {
+        fprintf(stderr, "Failed to load soup file '%s': %s\n", path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    struct soup_result *results = calloc(MAX(count, (size_t)1), sizeof(*results));
+    if (!results) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    double start = monotonic_seconds();
+    soup_batch_run(soups, results, count, rule, max_generations);
+    double elapsed = monotonic_seconds() - start;
+
+    size_t settled = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const struct soup_result *result = &results[i];
+        int min_x = INT_MAX, min_y = INT_MAX, max_x = INT_MIN, max_y = INT_MIN;
+        struct cell_iterator it = cell_set_iter(&soups[i]);
+        int x, y;
+        while (cell_iter_next(&it, &x, &y)) {
+            min_x = MIN(min_x, x);
+            max_x = MAX(max_x, x);
+            min_y = MIN(min_y, y);
+            max_y = MAX(max_y, y);
+        }
+        printf("#Soup %zu: generation %zu | period %zu | population %zu | escapees %llu gliders, %llu LWSS, %llu MWSS, %llu HWSS",
+               i + 1, result->generations, result->period, result->population, (unsigned long long)result->escapees[SHIP_GLIDER],
+               (unsigned long long)result->escapees[SHIP_LWSS], (unsigned long long)result->escapees[SHIP_MWSS],
+               (unsigned long long)result->escapees[SHIP_HWSS]);
+        if (result->population > 0) {
+            printf(" | origin (%d, %d)", min_x, min_y);
+        }
+        printf("\n");
+        for (int row = min_y; result->population > 0 && row <= max_y; ++row) {
+            for (int col = min_x; col <= max_x; ++col) {
+                putchar(cell_set_contains(&soups[i], col, row) ? 'O' : '.');
+            }
+            putchar('\n');
         }
+        putchar('\n');
+        settled += result->period ? 1 : 0;
+        cell_set_destroy(&soups[i]);
+    }
+    printf("#Soups: %zu | settled %zu | %.3f s\n", count, settled, elapsed);
+    free(soups);
+    free(results);
+    return EXIT_SUCCESS;
+}
 
-        render_state_terminal(life, &view, paused, delay_ms, info_message);
-        info_message[0] = '\0';
+struct insert_bench_job {
+    const int *coords;
+    size_t begin;
+    size_t end;
+    struct concurrent_cell_set *shared;
+    struct cell_set local;
+};
 
-        if (delay_ms > 0) {
-            struct timespec req = {delay_ms / 1000, (delay_ms % 1000) * 1000000L};
-            nanosleep(&req, NULL);
-        }
+static void insert_bench_shared_run(void *arg) {
+    struct insert_bench_job *job = arg;
+    for (size_t i = job->begin; i < job->end; ++i) {
+        concurrent_cell_set_insert(job->shared, job->coords[2 * i], job->coords[2 * i + 1]);
     }
+}
 
-    restore_terminal();
-    clear_screen();
-    return EXIT_SUCCESS;
+static void insert_bench_local_run(void *arg) {
+    struct insert_bench_job *job = arg;
+    for (size_t i = job->begin; i < job->end; ++i) {
+        cell_set_insert(&job->local, job->coords[2 * i], job->coords[2 * i + 1]);
+    }
 }
 
-static int run_gui(struct life_state *life, int delay_ms) {
-    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
-        fprintf(stderr, "SDL_Init failed: %s\n", SDL_GetError());
-        return EXIT_FAILURE;
+static void bench_insert(struct scheduler *sched) {
+    const size_t cells = 2000000;
+    int *coords = malloc(cells * 2 * sizeof(int));
+    struct insert_bench_job *jobs = calloc((size_t)sched->worker_count, sizeof(struct insert_bench_job));
+    if (!coords || !jobs) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    uint64_t seed = 1;
+    for (size_t i = 0; i < cells * 2; ++i) {
+        seed = mix64(seed + i);
+        coords[i] = (int)(seed % 4096) - 2048;
     }
 
-    SDL_Window *window = SDL_CreateWindow("GameOfLifeGpt", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 1024, 768, SDL_WINDOW_RESIZABLE);
-    if (!window) {
-        fprintf(stderr, "SDL_CreateWindow failed: %s\n", SDL_GetError());
-        SDL_Quit();
-        return EXIT_FAILURE;
+    struct concurrent_cell_set shared;
+    concurrent_cell_set_init(&shared, cells);
+    struct task_group group;
+    atomic_init(&group.pending, 0);
+    double start = monotonic_seconds();
+    for (int w = 0; w < sched->worker_count; ++w) {
+        jobs[w].coords = coords;
+        jobs[w].begin = cells * (size_t)w / (size_t)sched->worker_count;
+        jobs[w].end = cells * (size_t)(w + 1) / (size_t)sched->worker_count;
+        jobs[w].shared = &shared;
+        scheduler_spawn_on(sched, w, &group, insert_bench_shared_run, &jobs[w]);
     }
+    scheduler_wait(sched, &group);
+    double shared_seconds = monotonic_seconds() - start;
 
-    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
-    if (!renderer) {
-        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    start = monotonic_seconds();
+    for (int w = 0; w < sched->worker_count; ++w) {
+        cell_set_init(&jobs[w].local, INITIAL_HASH_CAPACITY);
+        scheduler_spawn_on(sched, w, &group, insert_bench_local_run, &jobs[w]);
     }
-    if (!renderer) {
-        fprintf(stderr, "SDL_CreateRenderer failed: %s\n", SDL_GetError());
-        SDL_DestroyWindow(window);
-        SDL_Quit();
-        return EXIT_FAILURE;
+    scheduler_wait(sched, &group);
+    double local_seconds = monotonic_seconds() - start;
+    struct cell_set merged;
+    cell_set_init(&merged, INITIAL_HASH_CAPACITY);
+    for (int w = 0; w < sched->worker_count; ++w) {
+        struct cell_iterator it = cell_set_iter(&jobs[w].local);
+        int x, y;
+        while (cell_iter_next(&it, &x, &y)) {
+            cell_set_insert(&merged, x, y);
+        }
     }
+    double merge_seconds = monotonic_seconds() - start - local_seconds;
 
-    struct view_state view;
-    view_init(&view);
+    printf("Insert benchmark: %zu inserts, %zu distinct cells, %d threads\n", cells, concurrent_cell_set_count(&shared), sched->worker_count);
+    printf("  concurrent CAS set:       %.3f s (%.1f M inserts/s)\n", shared_seconds, (double)cells / shared_seconds / 1e6);
+    printf("  per-thread sets + merge:  %.3f s (insert %.3f s, merge %.3f s, %zu cells)\n", local_seconds + merge_seconds,
+           local_seconds, merge_seconds, cell_set_count(&merged));
 
-    bool paused = false;
-    bool single_step = false;
-    bool running = true;
-    bool dragging = false;
-    char info_message[128] = "Press q to quit, p to pause.";
+    for (int w = 0; w < sched->worker_count; ++w) {
+        cell_set_destroy(&jobs[w].local);
+    }
+    cell_set_destroy(&merged);
+    concurrent_cell_set_destroy(&shared);
+    free(jobs);
+    free(coords);
+}
 
-    while (running) {
-        SDL_Event event;
-        while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_QUIT) {
-                running = false;
-            } else if (event.type == SDL_KEYDOWN) {
-                SDL_Keycode key = event.key.keysym.sym;
-                if (key == SDLK_q) {
-                    running = false;
-                } else if (key == SDLK_p) {
-                    paused = !paused;
-                } else if (key == SDLK_n) {
-                    single_step = true;
-                } else if (key == SDLK_w) {
-                    view_pan(&view, 0, -1);
-                } else if (key == SDLK_s) {
-                    view_pan(&view, 0, 1);
-                } else if (key == SDLK_a) {
-                    view_pan(&view, -1, 0);
-                } else if (key == SDLK_d) {
-                    view_pan(&view, 1, 0);
-                } else if (key == SDLK_PLUS || key == SDLK_EQUALS || key == SDLK_KP_PLUS) {
-                    view_zoom_in(&view);
-                } else if (key == SDLK_MINUS || key == SDLK_KP_MINUS) {
-                    view_zoom_out(&view);
-                } else if (key == SDLK_r) {
-                    view_init(&view);
-                    snprintf(info_message, sizeof(info_message), "View reset to origin");
-                }
-            } else if (event.type == SDL_MOUSEWHEEL) {
-                if (event.wheel.y > 0) {
-                    for (int i = 0; i < event.wheel.y; ++i) {
-                        view_zoom_in(&view);
-                    }
-                } else if (event.wheel.y < 0) {
-                    for (int i = 0; i < -event.wheel.y; ++i) {
-                        view_zoom_out(&view);
-                    }
-                }
-            } else if (event.type == SDL_MOUSEBUTTONDOWN) {
-                if (event.button.button == SDL_BUTTON_LEFT) {
-                    dragging = true;
-                }
-            } else if (event.type == SDL_MOUSEBUTTONUP) {
-                if (event.button.button == SDL_BUTTON_LEFT) {
-                    dragging = false;
-                }
-            } else if (event.type == SDL_MOUSEMOTION) {
-                if (dragging) {
-                    view_pan_pixels(&view, -(double)event.motion.xrel, -(double)event.motion.yrel);
+/* The table is far larger than the last-level cache, so every lookup is a
+   miss; half of the probes hit live cells. */
+static void bench_lookup(void) {
+    const size_t cells = 8000000;
+    const size_t lookups = 16000000;
+    struct cell_set set;
+    cell_set_init(&set, cells * 2);
+    uint64_t *keys = malloc(lookups * sizeof(*keys));
+    bool *found = malloc(lookups * sizeof(*found));
+    if (!keys || !found) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    uint64_t seed = 7;
+    for (size_t i = 0; i < cells; ++i) {
+        seed = mix64(seed + i);
+        cell_set_insert(&set, (int)(seed >> 40) - (1 << 23), (int)(seed & 0xffffff) - (1 << 23));
+    }
+    seed = 7;
+    uint64_t miss = 99;
+    for (size_t i = 0; i < lookups; ++i) {
+        if (i % 2 == 0) {
+            seed = mix64(seed + i / 2);
+            keys[i] = cell_key((int)(seed >> 40) - (1 << 23), (int)(seed & 0xffffff) - (1 << 23));
+        } else {
+            miss = mix64(miss + i);
+            keys[i] = cell_key((int)(miss >> 40), (int)(miss & 0xffffff) + (1 << 24));
+        }
+    }
+
+    size_t hits = 0;
+    double start = monotonic_seconds();
+    for (size_t i = 0; i < lookups; ++i) {
+        hits += cell_set_contains(&set, cell_key_x(keys[i]), cell_key_y(keys[i])) ? 1 : 0;
+    }
+    double single_seconds = monotonic_seconds() - start;
+
+    size_t batch_hits = 0;
+    start = monotonic_seconds();
+    cell_set_contains_batch(&set, keys, lookups, found);
+    for (size_t i = 0; i < lookups; ++i) {
+        batch_hits += found[i] ? 1 : 0;
+    }
+    double batch_seconds = monotonic_seconds() - start;
+
+    printf("Lookup benchmark: %zu lookups in a set of %zu cells (%zu MiB of slots)\n", lookups, cell_set_count(&set),
+           cell_set_memory_bytes(&set) >> 20);
+    printf("  one at a time:       %.3f s (%.1f M lookups/s, %zu hits)\n", single_seconds, (double)lookups / single_seconds / 1e6, hits);
+    printf("  batched, prefetched: %.3f s (%.1f M lookups/s, %zu hits)\n", batch_seconds, (double)lookups / batch_seconds / 1e6,
+           batch_hits);
+
+    cell_set_destroy(&set);
+    free(keys);
+    free(found);
+}
+
+static void soup_shed_escapees(struct life_state *state) {
+    size_t before;
+    do {
+        before = state->census.population;
+        life_state_remove_escapees(state);
+    } while (state->census.population < before);
+}
+
+/* Runs the same 16x16 soups through the 64-lane batch and through one
+   life_state per soup, stepped to the generation the batch stopped at. */
+static void bench_soup(void) {
+    const size_t count = 1024;
+    const size_t limit = SOUP_DEFAULT_GENERATIONS;
+    struct cell_set *soups = calloc(count, sizeof(*soups));
+    struct soup_result *results = calloc(count, sizeof(*results));
+    if (!soups || !results) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    uint64_t seed = 11;
+    for (size_t i = 0; i < count; ++i) {
+        cell_set_init(&soups[i], 256);
+        for (int y = 0; y < 16; ++y) {
+            seed = mix64(seed + i * 16 + (size_t)y);
+            for (int x = 0; x < 16; ++x) {
+                if ((seed >> x) & 1u) {
+                    cell_set_insert(&soups[i], x, y);
                 }
             }
         }
+    }
 
-        if ((!paused) || single_step) {
-            life_state_step(life);
-            single_step = false;
+    struct life_state *singles = calloc(count, sizeof(*singles));
+    if (!singles) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        life_state_init(&singles[i]);
+        struct cell_iterator it = cell_set_iter(&soups[i]);
+        int x, y;
+        while (cell_iter_next(&it, &x, &y)) {
+            cell_set_insert(&singles[i].live, x, y);
         }
+    }
 
-        int width = 0;
-        int height = 0;
-        SDL_GetRendererOutputSize(renderer, &width, &height);
-        if (width <= 0 || height <= 0) {
-            SDL_GetWindowSize(window, &width, &height);
-        }
-        if (width <= 0) {
-            width = 1;
-        }
-        if (height <= 0) {
-            height = 1;
-        }
-        render_state_sdl(renderer, life, &view, width, height);
+    double start = monotonic_seconds();
+    soup_batch_run(soups, results, count, &CONWAY_RULE, limit);
+    double batch_seconds = monotonic_seconds() - start;
 
-        char title[256];
-        snprintf(title, sizeof(title),
-                 "GameOfLifeGpt | Gen: %zu | Live: %zu | Speed: %d ms | Scale: %d | Center: (%d,%d) | %s",
-                 life->generation, cell_set_count(&life->live), delay_ms, view.scale, view.center_x, view.center_y,
-                 paused ? "Paused" : "Running");
-        if (info_message[0]) {
-            size_t len = strlen(title);
-            if (len < sizeof(title)) {
-                snprintf(title + len, sizeof(title) - len, " | %s", info_message);
-            }
+    size_t generations = 0;
+    start = monotonic_seconds();
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t g = 0; g < results[i].generations; ++g) {
+            life_state_step(&singles[i]);
         }
-        SDL_SetWindowTitle(window, title);
-        info_message[0] = '\0';
-
-        SDL_RenderPresent(renderer);
+        generations += results[i].generations;
+    }
+    double single_seconds = monotonic_seconds() - start;
 
-        if (delay_ms > 0) {
-            SDL_Delay((Uint32)delay_ms);
+    /* The batch drops ships at the field edge, so both sides shed their
+       remaining escapees before the states and ship counts are compared.
+       A pass can keep a ship that only a farther one, removed later in the
+       same pass, made look hemmed in, so passes repeat until none is found. */
+    size_t settled = 0, unbatched = 0, agree = 0;
+    uint64_t ships = 0;
+    for (size_t i = 0; i < count; ++i) {
+        struct life_state batched;
+        life_state_init(&batched);
+        soup_copy_cells(&batched.live, &soups[i]);
+        life_state_recount(&batched);
+        soup_shed_escapees(&batched);
+        life_state_recount(&singles[i]);
+        soup_shed_escapees(&singles[i]);
+        uint64_t batch_ships = 0, single_ships = 0;
+        for (int kind = 0; kind < SHIP_KINDS; ++kind) {
+            batch_ships += results[i].escapees[kind] + batched.stats.escapees[kind];
+            single_ships += singles[i].stats.escapees[kind];
         }
+        settled += results[i].period ? 1 : 0;
+        unbatched += results[i].unbatched ? 1 : 0;
+        ships += batch_ships;
+        agree += soup_cells_equal(&singles[i].live, &batched.live) && batch_ships == single_ships ? 1 : 0;
+        life_state_destroy(&batched);
+        life_state_destroy(&singles[i]);
+        cell_set_destroy(&soups[i]);
     }
+    printf("Soup benchmark: %zu 16x16 soups, %zu generations in total, %zu settled, %llu spaceships escaped, %zu left the batch\n",
+           count, generations, settled, (unsigned long long)ships, unbatched);
+    printf("  one life_state per soup: %.3f s (%.1f soups/s)\n", single_seconds, (double)count / single_seconds);
+    printf("  64-lane soup batches:    %.3f s (%.1f soups/s, %.1fx)\n", batch_seconds, (double)count / batch_seconds,
+           single_seconds / batch_seconds);
+    printf("  final states agree for %zu of %zu soups\n", agree, count);
+    free(singles);
+    free(soups);
+    free(results);
+}
 
-    SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
-    SDL_Quit();
-    return EXIT_SUCCESS;
+static int run_benchmark(const char *name, int threads, bool numa) {
+    struct scheduler *sched = scheduler_create(threads, numa);
+    int result = EXIT_SUCCESS;
+    if (strcmp(name, "insert") == 0) {
+        bench_insert(sched);
+    } else if (strcmp(name, "lookup") == 0) {
+        bench_lookup();
+    } else if (strcmp(name, "soup") == 0) {
+        bench_soup();
+    } else {
+        fprintf(stderr, "Unknown benchmark: %s\n", name);
+        result = EXIT_FAILURE;
+    }
+    scheduler_destroy(sched);
+    return result;
+}
+
+/* Parses a positive byte count with an optional K, M or G suffix. */
+static bool parse_size(const char *text, size_t *out) {
+    char *end = NULL;
+    errno = 0;
+    unsigned long long value = strtoull(text, &end, 10);
+    int shift = 0;
+    if (end && (*end == 'K' || *end == 'k')) {
+        shift = 10;
+    } else if (end && (*end == 'M' || *end == 'm')) {
+        shift = 20;
+    } else if (end && (*end == 'G' || *end == 'g')) {
+        shift = 30;
+    }
+    if (shift) {
+        end++;
+    }
+    if (errno != 0 || !end || end == text || *end != '\0' || text[0] == '-' || value == 0 || value > (SIZE_MAX >> shift)) {
+        return false;
+    }
+    *out = (size_t)value << shift;
+    return true;
 }
 
 static void usage(const char *prog) {
-    fprintf(stderr, "Usage: %s [-t delay_ms] [-f file] [-g]\n", prog);
+    fprintf(stderr, "Usage: %s [-t delay_ms] [-f file] [-g] [-n generations] [-j threads] [-B benchmark] [--no-numa] [--distributed N]\n", prog);
+    fprintf(stderr, "       [-r rule] [--publish NAME] [--http PORT [--http-dir DIR]] [--metrics-file PATH] [--remove-escapees] [--huge-pages]\n");
+    fprintf(stderr, "       [--cold-store PATH | --compress-cold] [--max-memory SIZE]\n");
+    fprintf(stderr, "       [--memo-cache PATH [--memo-cache-size SIZE]]\n");
+    fprintf(stderr, "       %s --soups FILE [-n generations] [-r rule]\n", prog);
+    fprintf(stderr, "       %s --observe NAME\n", prog);
     fprintf(stderr, "  -t delay_ms  Set delay between generations in milliseconds (default 200)\n");
     fprintf(stderr, "  -f file      Load initial configuration from file\n");
     fprintf(stderr, "  -g           Launch the SDL2 graphical renderer\n");
+    fprintf(stderr, "  -n gens      Run headless for the given number of generations and print statistics\n");
+    fprintf(stderr, "  -j threads   Step tiles in parallel on the given number of threads (default 1)\n");
+    fprintf(stderr, "  -B name      Run a micro-benchmark (insert, lookup, soup) and exit\n");
+    fprintf(stderr, "  -r rule      B/S rule (default B3/S23) or Larger than Life rule (R5,C0,M1,S34..58,B34..45,NM)\n");
+    fprintf(stderr, "  --no-numa    Disable node-aware tile scheduling and thread pinning\n");
+    fprintf(stderr, "  --distributed N\n");
+    fprintf(stderr, "               With -n, split the plane into column strips owned by N worker processes\n");
+    fprintf(stderr, "  --publish NAME\n");
+    fprintf(stderr, "               Publish every generation to the POSIX shared-memory segment /NAME\n");
+    fprintf(stderr, "  --http PORT  Serve JSON status and control commands on 127.0.0.1:PORT\n");
+    fprintf(stderr, "  --http-dir DIR\n");
+    fprintf(stderr, "               Let /load and /snapshot read and write pattern files in DIR (off by default)\n");
+    fprintf(stderr, "  --metrics-file PATH\n");
+    fprintf(stderr, "               Periodically write Prometheus text-format metrics to PATH\n");
+    fprintf(stderr, "  --huge-pages Back large tables and tile arenas with 2 MiB pages where the system allows\n");
+    fprintf(stderr, "  --cold-store PATH\n");
+    fprintf(stderr, "               With -n, evict settled tiles to a new scratch file at PATH, mapped into memory\n");
+    fprintf(stderr, "  --compress-cold\n");
+    fprintf(stderr, "               With -n, keep settled tiles run-length compressed in memory instead\n");
+    fprintf(stderr, "  --max-memory SIZE\n");
+    fprintf(stderr, "               Collect the tile store between steps to stay within SIZE bytes (K, M, G suffixes; default 128M)\n");
+    fprintf(stderr, "  --memo-cache PATH\n");
+    fprintf(stderr, "               Keep tile step results in a file at PATH and reuse them in later runs\n");
+    fprintf(stderr, "  --memo-cache-size SIZE\n");
+    fprintf(stderr, "               Size of a newly created memo cache file (default 256M)\n");
+    fprintf(stderr, "  --remove-escapees\n");
+    fprintf(stderr, "               Delete gliders and spaceships that have escaped the pattern (B3/S23 only)\n");
+    fprintf(stderr, "  --soups FILE\n");
+    fprintf(stderr, "               Run the blank-line separated soups in FILE in batches until they settle or for\n");
+    fprintf(stderr, "               -n generations (default 4000), print their final states and exit\n");
+    fprintf(stderr, "  --observe NAME\n");
+    fprintf(stderr, "               Print a consistent snapshot of a published segment and exit\n");
 }
 
 int main(int argc, char **argv) {
@@ -785,7 +7458,45 @@ int main(int argc, char **argv) {
     int delay_ms = 200;
     const char *file_path = NULL;
     bool use_gui = false;
-    while ((opt = getopt(argc, argv, "t:f:hg")) != -1) {
+    bool headless = false;
+    size_t generations = 0;
+    int threads = 1;
+    const char *benchmark = NULL;
+    const char *soups_path = NULL;
+    bool numa = true;
+    int processes = 0;
+    const char *publish_name = NULL;
+    const char *metrics_path = NULL;
+    const char *cold_path = NULL;
+    bool compress_cold = false;
+    size_t max_memory = TILE_STORE_DEFAULT_BUDGET;
+    const char *memo_cache_path = NULL;
+    size_t memo_cache_size = MEMO_CACHE_DEFAULT_SIZE;
+    bool remove_escapees = false;
+    int http_port = 0;
+    const char *http_dir = NULL;
+    struct life_rule rule = CONWAY_RULE;
+    static const struct option long_options[] = {
+        {"no-numa", no_argument, NULL, 'N'},
+        {"distributed", required_argument, NULL, 'D'},
+        {"publish", required_argument, NULL, 'P'},
+        {"observe", required_argument, NULL, 'O'},
+        {"http", required_argument, NULL, 'H'},
+        {"http-dir", required_argument, NULL, 'W'},
+        {"rule", required_argument, NULL, 'r'},
+        {"metrics-file", required_argument, NULL, 'M'},
+        {"remove-escapees", no_argument, NULL, 'E'},
+        {"huge-pages", no_argument, NULL, 'L'},
+        {"cold-store", required_argument, NULL, 'C'},
+        {"compress-cold", no_argument, NULL, 'Z'},
+        {"max-memory", required_argument, NULL, 'X'},
+        {"memo-cache", required_argument, NULL, 'Y'},
+        {"memo-cache-size", required_argument, NULL, 'S'},
+        {"soups", required_argument, NULL, 'U'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0},
+    };
+    while ((opt = getopt_long(argc, argv, "t:f:hgn:j:B:r:", long_options, NULL)) != -1) {
         switch (opt) {
             case 't':
                 delay_ms = atoi(optarg);
@@ -800,6 +7511,92 @@ int main(int argc, char **argv) {
             case 'g':
                 use_gui = true;
                 break;
+            case 'n': {
+                char *end = NULL;
+                errno = 0;
+                unsigned long long value = strtoull(optarg, &end, 10);
+                if (errno != 0 || !end || *end != '\0' || optarg[0] == '-') {
+                    fprintf(stderr, "Invalid generation count: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                generations = (size_t)value;
+                headless = true;
+                break;
+            }
+            case 'j':
+                threads = atoi(optarg);
+                if (threads < 1) {
+                    fprintf(stderr, "Invalid thread count: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'B':
+                benchmark = optarg;
+                break;
+            case 'N':
+                numa = false;
+                break;
+            case 'P':
+                publish_name = optarg;
+                break;
+            case 'M':
+                metrics_path = optarg;
+                break;
+            case 'E':
+                remove_escapees = true;
+                break;
+            case 'L':
+                huge_pages_enabled = true;
+                break;
+            case 'C':
+                cold_path = optarg;
+                break;
+            case 'Z':
+                compress_cold = true;
+                break;
+            case 'X':
+                if (!parse_size(optarg, &max_memory)) {
+                    fprintf(stderr, "Invalid memory size: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'Y':
+                memo_cache_path = optarg;
+                break;
+            case 'S':
+                if (!parse_size(optarg, &memo_cache_size)) {
+                    fprintf(stderr, "Invalid memo cache size: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'W':
+                http_dir = optarg;
+                break;
+            case 'U':
+                soups_path = optarg;
+                break;
+            case 'H':
+                http_port = atoi(optarg);
+                if (http_port < 1 || http_port > 65535) {
+                    fprintf(stderr, "Invalid port: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'r':
+                if (!life_rule_parse(optarg, &rule)) {
+                    fprintf(stderr, "Invalid rule: %s (expected B.../S... or R..,C..,M..,S..,B..,N.. notation without B0)\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'O':
+                return run_observer(optarg);
+            case 'D':
+                processes = atoi(optarg);
+                if (processes < 1) {
+                    fprintf(stderr, "Invalid process count: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
             case 'h':
             default:
                 usage(argv[0]);
@@ -807,19 +7604,99 @@ int main(int argc, char **argv) {
         }
     }
 
+    if (benchmark) {
+        return run_benchmark(benchmark, threads, numa);
+    }
+    if (soups_path) {
+        return run_soups(soups_path, &rule, headless ? generations : SOUP_DEFAULT_GENERATIONS);
+    }
+    if (processes > 0 && life_rule_is_ltl(&rule)) {
+        fprintf(stderr, "--distributed only supports range-1 B/S rules\n");
+        return EXIT_FAILURE;
+    }
+    if ((cold_path || compress_cold) && (!headless || processes > 0)) {
+        fprintf(stderr, "--cold-store and --compress-cold need a headless run (-n) without --distributed\n");
+        return EXIT_FAILURE;
+    }
+    struct stat dir_stat;
+    if (http_dir && (stat(http_dir, &dir_stat) == -1 || !S_ISDIR(dir_stat.st_mode))) {
+        fprintf(stderr, "--http-dir %s is not a directory\n", http_dir);
+        return EXIT_FAILURE;
+    }
+    if (memo_cache_path && processes > 0) {
+        fprintf(stderr, "--memo-cache is not supported with --distributed\n");
+        return EXIT_FAILURE;
+    }
+    if (cold_path && compress_cold) {
+        fprintf(stderr, "--cold-store and --compress-cold are alternatives\n");
+        return EXIT_FAILURE;
+    }
+
     struct life_state life;
     life_state_init(&life);
+    life.rule = rule;
+    life.metrics_path = metrics_path;
+    life.remove_escapees = remove_escapees;
+    life.tile_store.budget = max_memory;
+    if (memo_cache_path) {
+        char error[256];
+        life.tile_store.cache = memo_cache_open(memo_cache_path, memo_cache_size, &rule, error, sizeof(error));
+        if (!life.tile_store.cache) {
+            fprintf(stderr, "Failed to open memo cache '%s': %s\n", memo_cache_path, error);
+            life_state_destroy(&life);
+            return EXIT_FAILURE;
+        }
+    }
+    if ((cold_path || compress_cold) && !cold_store_open(&life.cold, cold_path)) {
+        fprintf(stderr, "Failed to open cold store '%s': %s\n", cold_path, strerror(errno));
+        life_state_destroy(&life);
+        return EXIT_FAILURE;
+    }
+    if (threads > 1) {
+        life.scheduler = scheduler_create(threads, numa);
+    }
+    if (publish_name) {
+        life.publisher = publisher_create(publish_name);
+        if (!life.publisher) {
+            scheduler_destroy(life.scheduler);
+            life_state_destroy(&life);
+            return EXIT_FAILURE;
+        }
+    }
 
     if (file_path) {
         if (life_state_import_file(&life, file_path) == -1) {
             fprintf(stderr, "Failed to load configuration file '%s': %s\n", file_path, strerror(errno));
+            publisher_destroy(life.publisher);
+            scheduler_destroy(life.scheduler);
+            life_state_destroy(&life);
+            return EXIT_FAILURE;
+        }
+    }
+    publisher_publish(life.publisher, &life);
+    if (http_port > 0) {
+        life.control = control_server_create(http_port, http_dir);
+        if (!life.control) {
+            publisher_destroy(life.publisher);
+            scheduler_destroy(life.scheduler);
             life_state_destroy(&life);
             return EXIT_FAILURE;
         }
+        control_update_status(life.control, &life, false, NULL);
     }
 
-    int result = use_gui ? run_gui(&life, delay_ms) : run_terminal(&life, delay_ms);
+    int result;
+    if (headless && processes > 0) {
+        result = run_distributed(&life, generations, processes);
+    } else if (headless) {
+        result = run_headless(&life, generations);
+    } else {
+        result = use_gui ? run_gui(&life, delay_ms) : run_terminal(&life, delay_ms);
+    }
 
+    control_server_destroy(life.control);
+    publisher_destroy(life.publisher);
+    scheduler_destroy(life.scheduler);
     life_state_destroy(&life);
     return result;
 }
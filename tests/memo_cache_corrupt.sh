@@ -0,0 +1,76 @@
+#!/bin/sh
+# Runs a soup against a --memo-cache file after damaging the file in several
+# ways and checks that every run still matches a run without the cache.
+# Usage: tests/memo_cache_corrupt.sh path/to/gameoflife
+set -eu
+
+bin=${1:?usage: $0 path/to/gameoflife}
+here=$(cd "$(dirname "$0")" && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+pattern=$here/../patterns/gosper_glider_gun.txt
+gens=2000
+# The header is 112 bytes; everything after it is tile and result tables.
+header=112
+
+summary() {
+    timeout 60 "$bin" -f "$pattern" -n "$gens" "$@" | grep '^Generation' | sed 's/ | Elapsed.*//'
+}
+
+expected=$(summary)
+fail=0
+
+check() {
+    name=$1
+    shift
+    if ! got=$(summary --memo-cache "$work/cache" "$@"); then
+        echo "FAIL $name: run exited with an error"
+        fail=1
+    elif [ "$got" != "$expected" ]; then
+        echo "FAIL $name: got '$got', expected '$expected'"
+        fail=1
+    else
+        echo "ok   $name"
+    fi
+}
+
+fresh() {
+    rm -f "$work/cache"
+    summary --memo-cache "$work/cache" --memo-cache-size 1M >/dev/null
+}
+
+fresh
+check "intact cache"
+
+# Every tile tag and result entry set: full tables with nonsense ids.
+fresh
+size=$(wc -c <"$work/cache")
+head -c $((size - header)) /dev/zero | tr '\0' '\377' |
+    dd of="$work/cache" bs=1 seek=$header conv=notrunc 2>/dev/null
+check "tables filled with 0xff"
+
+# Random bytes over the tables.
+fresh
+head -c $((size - header)) /dev/urandom | dd of="$work/cache" bs=1 seek=$header conv=notrunc 2>/dev/null
+check "tables overwritten with random bytes"
+
+# Random bytes over the second half only: results point at damaged tiles.
+fresh
+half=$(((size - header) / 2))
+head -c $half /dev/urandom | dd of="$work/cache" bs=1 seek=$((size - half)) conv=notrunc 2>/dev/null
+check "results overwritten with random bytes"
+
+# A file that is not a cache is refused and left alone.
+cp "$pattern" "$work/cache"
+if "$bin" -f "$pattern" -n 1 --memo-cache "$work/cache" >/dev/null 2>&1; then
+    echo "FAIL foreign file: run accepted it"
+    fail=1
+elif ! cmp -s "$pattern" "$work/cache"; then
+    echo "FAIL foreign file: file was modified"
+    fail=1
+else
+    echo "ok   foreign file refused"
+fi
+
+exit $fail